@@ -0,0 +1,141 @@
+#include "bench/bench.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFn fn;
+};
+
+std::vector<Benchmark>& Registry() {
+  static std::vector<Benchmark> registry;
+  return registry;
+}
+
+// Quotes a string for JSON or CSV output, which is only ever used for names
+// and context that don't need escaping.
+std::string Quote(std::string_view s) {
+  DCHECK_EQ(s.find('"'), std::string_view::npos) << s;
+  return "\"" + std::string(s) + "\"";
+}
+
+}  // namespace
+
+State::State(int64_t iterations)
+    : iterations_(iterations), start_(Clock::now()) {}
+
+void State::ResetTimer() {
+  start_ = Clock::now();
+  stop_.reset();
+}
+
+void State::StopTimer() { stop_ = Clock::now(); }
+
+void RegisterBenchmark(std::string name, BenchmarkFn fn) {
+  Registry().push_back({std::move(name), std::move(fn)});
+}
+
+void ClearBenchmarks() { Registry().clear(); }
+
+std::vector<Result> Runner::Run(std::string_view filter, double min_seconds) {
+  std::vector<Result> results;
+  for (const Benchmark& benchmark : Registry()) {
+    if (benchmark.name.find(filter) == std::string::npos) continue;
+    int64_t iterations = 1;
+    while (true) {
+      State state(iterations);
+      benchmark.fn(state);
+      const double seconds =
+          std::chrono::duration<double>(
+              state.stop_.value_or(State::Clock::now()) - state.start_)
+              .count();
+      if ((seconds >= min_seconds) || (iterations >= (int64_t{1} << 40))) {
+        results.push_back(
+            {benchmark.name, iterations, seconds * 1e9 / iterations,
+             state.items_per_iteration_ * iterations / seconds});
+        LOG(INFO) << benchmark.name << ": " << results.back().ns_per_iteration
+                  << " ns/iteration";
+        break;
+      }
+      // Aim for 1.5x the minimum time, but don't grow too quickly from a
+      // noisy short run.
+      const double scale = seconds > 0 ? 1.5 * min_seconds / seconds : 100;
+      iterations = std::max(iterations + 1,
+                            static_cast<int64_t>(iterations *
+                                                 std::min(scale, 100.0)));
+    }
+  }
+  return results;
+}
+
+void Runner::Write(
+    const std::vector<Result>& results,
+    const std::vector<std::pair<std::string, std::string>>& context,
+    Format format, std::ostream& out) {
+  switch (format) {
+    case kFormatText:
+      for (const auto& [key, value] : context) {
+        out << key << ": " << value << "\n";
+      }
+      out << std::left << std::setw(48) << "benchmark" << std::right
+          << std::setw(12) << "iterations" << std::setw(16) << "ns/iter"
+          << std::setw(16) << "items/s"
+          << "\n";
+      for (const Result& r : results) {
+        out << std::left << std::setw(48) << r.name << std::right
+            << std::setw(12) << r.iterations << std::setw(16) << std::fixed
+            << std::setprecision(1) << r.ns_per_iteration << std::setw(16)
+            << std::scientific << std::setprecision(3) << r.items_per_second
+            << std::defaultfloat << "\n";
+      }
+      return;
+    case kFormatJson:
+      out << "{\n  \"context\": {";
+      for (size_t i = 0; i < context.size(); ++i) {
+        out << (i ? ", " : "") << Quote(context[i].first) << ": "
+            << Quote(context[i].second);
+      }
+      out << "},\n  \"benchmarks\": [\n";
+      for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": " << Quote(r.name)
+            << ", \"iterations\": " << r.iterations
+            << ", \"ns_per_iteration\": " << r.ns_per_iteration
+            << ", \"items_per_second\": " << r.items_per_second << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+      }
+      out << "  ]\n}\n";
+      return;
+    case kFormatCsv:
+      out << "name,iterations,ns_per_iteration,items_per_second";
+      for (const auto& [key, value] : context) out << "," << key;
+      out << "\n";
+      for (const Result& r : results) {
+        out << Quote(r.name) << "," << r.iterations << ","
+            << r.ns_per_iteration << "," << r.items_per_second;
+        for (const auto& [key, value] : context) out << "," << Quote(value);
+        out << "\n";
+      }
+      return;
+    default:
+      CHECK(false) << "Not a real output format: " << format;
+  }
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,95 @@
+#ifndef LAND15_BENCH_BENCH_H_
+#define LAND15_BENCH_BENCH_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A minimal microbenchmark harness. Benchmarks are registered by name and run
+// with an increasing number of iterations until a run takes at least the
+// requested minimum time, the last run being the one reported.
+
+namespace land15 {
+namespace bench {
+
+class State {
+ public:
+  explicit State(int64_t iterations);
+
+  int64_t iterations() const { return iterations_; }
+
+  // Sets the number of items (pixels, characters, flakes...) processed by a
+  // single iteration, used to report throughput.
+  void SetItemsPerIteration(int64_t items) { items_per_iteration_ = items; }
+
+  // Restarts the clock, excluding anything done so far (like setup) from the
+  // timing.
+  void ResetTimer();
+
+  // Stops the clock, excluding anything done from then on (like tearing down
+  // large structures) from the timing.
+  void StopTimer();
+
+ private:
+  friend class Runner;
+  using Clock = std::chrono::steady_clock;
+
+  const int64_t iterations_;
+  int64_t items_per_iteration_ = 0;
+  Clock::time_point start_;
+  std::optional<Clock::time_point> stop_;
+};
+
+typedef std::function<void(State&)> BenchmarkFn;
+
+// Keeps the compiler from optimizing away the computation of `value`.
+template <class T>
+inline void DoNotOptimize(T value) {
+  volatile T sink = value;
+  (void)sink;
+}
+
+// Registers a benchmark, which must run `state.iterations()` iterations of the
+// thing being measured.
+void RegisterBenchmark(std::string name, BenchmarkFn fn);
+
+// Drops every registered benchmark along with anything they've captured, like
+// images, which must happen before Gfx is torn down.
+void ClearBenchmarks();
+
+struct Result {
+  std::string name;
+  int64_t iterations;
+  double ns_per_iteration;
+  // Zero if the benchmark didn't set the items per iteration.
+  double items_per_second;
+};
+
+enum Format { kFormatText, kFormatJson, kFormatCsv };
+
+class Runner {
+ public:
+  // Runs every registered benchmark whose name contains `filter`.
+  static std::vector<Result> Run(std::string_view filter, double min_seconds);
+
+  // Writes `results` to `out`, tagging them with `context` (pairs of keys and
+  // values describing the environment, like the backend used).
+  static void Write(
+      const std::vector<Result>& results,
+      const std::vector<std::pair<std::string, std::string>>& context,
+      Format format, std::ostream& out);
+
+ private:
+  Runner() = delete;
+};
+
+}  // namespace bench
+}  // namespace land15
+
+#endif  // LAND15_BENCH_BENCH_H_
@@ -0,0 +1,95 @@
+// Runs the microbenchmark suite, writing the results as text, JSON or CSV so
+// they can be compared across commits and machines. The drawing benchmarks run
+// against a 320x200 screen using the backend given by --bench_backend, which
+// defaults to headless software rendering so the suite can run anywhere.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "gflags/gflags.h"
+#include "gfx/blend.h"
+#include "gfx/gfx.h"
+#include "glog/logging.h"
+#include "SDL.h"
+
+DEFINE_string(bench_filter, "",
+              "Only run benchmarks whose name contains this string.");
+DEFINE_string(bench_format, "text", "Output format: text, json or csv.");
+DEFINE_string(bench_out, "", "File to write results to, stdout if empty.");
+DEFINE_double(bench_min_time, 0.5,
+              "Minimum time in seconds to run each benchmark for.");
+DEFINE_string(bench_backend, "headless",
+              "Gfx backend: headless, software or accelerated.");
+DEFINE_string(bench_video_driver, "",
+              "SDL video driver to use for windowed backends, like "
+              "\"offscreen\" or \"dummy\" on machines without a display.");
+DEFINE_string(bench_pack, "res.pack",
+              "Resource pack baked from res/ by land15_bake, to compare "
+              "loading from against decoding PNGs.");
+DEFINE_string(bench_label, "",
+              "Free-form label recorded with the results, like a commit.");
+
+using namespace land15;
+
+namespace {
+
+gfx::Gfx::Backend ParseBackend(const std::string& name) {
+  if (name == "headless") return gfx::Gfx::kBackendHeadless;
+  if (name == "software") return gfx::Gfx::kBackendSoftware;
+  CHECK_EQ(name, "accelerated") << "Not a real backend: " << name;
+  return gfx::Gfx::kBackendAccelerated;
+}
+
+bench::Format ParseFormat(const std::string& name) {
+  if (name == "text") return bench::kFormatText;
+  if (name == "json") return bench::kFormatJson;
+  CHECK_EQ(name, "csv") << "Not a real output format: " << name;
+  return bench::kFormatCsv;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  const gfx::Gfx::Backend backend = ParseBackend(FLAGS_bench_backend);
+  const bench::Format format = ParseFormat(FLAGS_bench_format);
+
+  if (!FLAGS_bench_video_driver.empty()) {
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, FLAGS_bench_video_driver.c_str());
+  }
+  gfx::Gfx::Screen({320, 200}, false, "land15 bench", {320, 200}, backend);
+
+  bench::RegisterBlendBenchmarks();
+  bench::RegisterGfxBenchmarks();
+  bench::RegisterJobsBenchmarks();
+  bench::RegisterLoadBenchmarks(FLAGS_bench_pack);
+  bench::RegisterRandomBenchmarks();
+  bench::RegisterSnowscreenBenchmarks();
+  bench::RegisterSpatialHashBenchmarks();
+  bench::RegisterTileMapBenchmarks();
+
+  const std::vector<bench::Result> results =
+      bench::Runner::Run(FLAGS_bench_filter, FLAGS_bench_min_time);
+  bench::ClearBenchmarks();
+
+  const std::vector<std::pair<std::string, std::string>> context = {
+      {"backend", FLAGS_bench_backend},
+      {"isa", gfx::blend::IsaName(gfx::blend::GetSupportedIsa())},
+      {"label", FLAGS_bench_label},
+  };
+  if (FLAGS_bench_out.empty()) {
+    bench::Runner::Write(results, context, format, std::cout);
+  } else {
+    std::ofstream out(FLAGS_bench_out);
+    CHECK(out) << "Couldn't open " << FLAGS_bench_out;
+    bench::Runner::Write(results, context, format, out);
+  }
+  return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef LAND15_BENCH_BENCHMARKS_H_
+#define LAND15_BENCH_BENCHMARKS_H_
+
+#include <string>
+
+// Registration of each group of benchmarks in the suite. Gfx must already be
+// initialized.
+
+namespace land15 {
+namespace bench {
+
+void RegisterBlendBenchmarks();
+void RegisterGfxBenchmarks();
+void RegisterJobsBenchmarks();
+// Pack loading benchmarks are skipped if there's no pack at `pack_filename`.
+void RegisterLoadBenchmarks(const std::string& pack_filename);
+void RegisterRandomBenchmarks();
+void RegisterSnowscreenBenchmarks();
+void RegisterSpatialHashBenchmarks();
+void RegisterTileMapBenchmarks();
+
+}  // namespace bench
+}  // namespace land15
+
+#endif  // LAND15_BENCH_BENCHMARKS_H_
@@ -0,0 +1,72 @@
+// Benchmarks of the span blending kernels in gfx/blend.h for every blend mode
+// and instruction set supported by this CPU. gfx/blend_test.cc checks that
+// they agree.
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "common/random.h"
+#include "gfx/blend.h"
+#include "gfx/core.h"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+using gfx::Color32;
+using gfx::blend::BlendMode;
+using gfx::blend::Isa;
+
+constexpr int kSpanLength = 320;
+constexpr int kSpans = 200;
+
+const char* const kBlendNames[] = {"none", "alpha", "add", "mod"};
+
+std::vector<Color32> RandomPixels(int n) {
+  std::vector<Color32> pixels;
+  pixels.reserve(n);
+  for (int i = 0; i < n; ++i) pixels.push_back(common::rnd());
+  return pixels;
+}
+
+void BM_BlendSpan(State& state, BlendMode blend, Isa isa, Color32 mod) {
+  const auto kernel = gfx::blend::GetSpanKernel(blend, isa);
+  const std::vector<Color32> src = RandomPixels(kSpanLength * kSpans);
+  std::vector<Color32> dst = RandomPixels(kSpanLength * kSpans);
+  state.SetItemsPerIteration(kSpanLength * kSpans);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int s = 0; s < kSpans; ++s) {
+      kernel(dst.data() + s * kSpanLength, src.data() + s * kSpanLength,
+             kSpanLength, mod);
+    }
+  }
+  DoNotOptimize(dst[0].value);
+}
+
+}  // namespace
+
+void RegisterBlendBenchmarks() {
+  const Isa best = gfx::blend::GetSupportedIsa();
+  for (int b = 0; b < 4; ++b) {
+    const BlendMode blend = static_cast<BlendMode>(b);
+    for (int i = 0; i <= best; ++i) {
+      const Isa isa = static_cast<Isa>(i);
+      const std::string name = std::string("blend/") + kBlendNames[blend] +
+                               "/" + gfx::blend::IsaName(isa);
+      RegisterBenchmark(name, [blend, isa](State& state) {
+        BM_BlendSpan(state, blend, isa, Color32::kWhite);
+      });
+      RegisterBenchmark(name + "/mod", [blend, isa](State& state) {
+        BM_BlendSpan(state, blend, isa, Color32(0x80c0ff80));
+      });
+    }
+  }
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,315 @@
+// Benchmarks of the Gfx drawing API. Each iteration draws a frame of some
+// number of operations followed by a Flip(), so the numbers include whatever
+// the backend does to get the frame on screen.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "common/random.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "gfx/text_cache.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+using gfx::Gfx;
+using glm::ivec2;
+
+const std::string kBackgroundFilename = "res/snowscreen.png";
+const std::string kFlakesFilename = "res/flakes.png";
+
+constexpr int kSpritesPerFrame = 1000;
+constexpr int kPrimitivesPerFrame = 1000;
+constexpr int kTextPerFrame = 16;
+
+const char* const kBlendNames[] = {"none", "alpha", "add", "mod"};
+
+ivec2 RandomPoint() {
+  const ivec2 res = Gfx::GetResolution();
+  return {static_cast<int>(common::rnd() % res.x),
+          static_cast<int>(common::rnd() % res.y)};
+}
+
+std::string RandomText(int length) {
+  std::string text;
+  for (int i = 0; i < length; ++i) {
+    // Mostly printable characters with the occasional space to wrap on.
+    const char c = '!' + common::rnd() % 94;
+    text.push_back((common::rnd() % 8) ? c : ' ');
+  }
+  return text;
+}
+
+void BM_PutFlake(State& state, const gfx::Image& flakes,
+                 Gfx::PutOptions::BlendMode blend, bool modulate) {
+  Gfx::PutOptions opts;
+  opts.SetBlend(blend).SetMod(modulate ? gfx::Color32(0x80c0ffc0)
+                                       : gfx::Color32::kWhite);
+  state.SetItemsPerIteration(kSpritesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int s = 0; s < kSpritesPerFrame; ++s) {
+      Gfx::PutEx(flakes, RandomPoint(), opts, {8 * (s % 3), 0},
+                 {8 * (s % 3) + 7, 7});
+    }
+    Gfx::Flip();
+  }
+}
+
+void BM_PutBackground(State& state, const gfx::Image& background,
+                      Gfx::PutOptions::BlendMode blend) {
+  Gfx::PutOptions opts;
+  opts.SetBlend(blend);
+  const ivec2 res = Gfx::GetResolution();
+  state.SetItemsPerIteration(3 * res.x * res.y);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int layer = 0; layer < 3; ++layer) {
+      Gfx::PutEx(background, {0, 0}, opts, {320 * layer, 0},
+                 {320 * layer + 319, 199});
+    }
+    Gfx::Flip();
+  }
+}
+
+void BM_PSet(State& state) {
+  state.SetItemsPerIteration(kPrimitivesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int p = 0; p < kPrimitivesPerFrame; ++p) {
+      Gfx::PSet(RandomPoint(), common::rnd());
+    }
+    Gfx::Flip();
+  }
+}
+
+// An opaque pattern changing every frame.
+gfx::Color32 Pattern(int x, int y, int64_t frame) {
+  return static_cast<int32_t>(((x ^ y ^ frame) & 0xffffff) << 8 | 0xff);
+}
+
+// Fills the whole screen a pixel at a time, against writing the pixels of a
+// locked streaming image and drawing it.
+void BM_PSetScreen(State& state) {
+  const ivec2 res = Gfx::GetResolution();
+  state.SetItemsPerIteration(res.x * res.y);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int y = 0; y < res.y; ++y) {
+      for (int x = 0; x < res.x; ++x) Gfx::PSet({x, y}, Pattern(x, y, i));
+    }
+    Gfx::Flip();
+  }
+}
+
+void BM_LockScreen(State& state) {
+  const ivec2 res = Gfx::GetResolution();
+  std::unique_ptr<gfx::Image> image = gfx::Image::Streaming(res);
+  state.SetItemsPerIteration(res.x * res.y);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const gfx::PixelView pixels = image->Lock();
+    for (int y = 0; y < pixels.h; ++y) {
+      gfx::Color32* row = pixels.row(y);
+      for (int x = 0; x < pixels.w; ++x) row[x] = Pattern(x, y, i);
+    }
+    image->Unlock();
+    Gfx::Put(*image, {0, 0});
+    Gfx::Flip();
+  }
+}
+
+void BM_Line(State& state) {
+  state.SetItemsPerIteration(kPrimitivesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int p = 0; p < kPrimitivesPerFrame; ++p) {
+      Gfx::Line(RandomPoint(), RandomPoint(), common::rnd());
+    }
+    Gfx::Flip();
+  }
+}
+
+void BM_FillRect(State& state) {
+  state.SetItemsPerIteration(kPrimitivesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int p = 0; p < kPrimitivesPerFrame; ++p) {
+      Gfx::FillRect(RandomPoint(), {16, 16}, common::rnd());
+    }
+    Gfx::Flip();
+  }
+}
+
+// The same frames as BM_PSet, BM_Line and BM_FillRect, each drawn as a single
+// batch.
+void BM_PSetBatch(State& state) {
+  std::vector<ivec2> points(kPrimitivesPerFrame);
+  std::vector<gfx::Color32> colors(kPrimitivesPerFrame, gfx::Color32::kWhite);
+  state.SetItemsPerIteration(kPrimitivesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int p = 0; p < kPrimitivesPerFrame; ++p) {
+      points[p] = RandomPoint();
+      colors[p] = common::rnd();
+    }
+    Gfx::PSet(points, colors);
+    Gfx::Flip();
+  }
+}
+
+void BM_LineBatch(State& state) {
+  std::vector<Gfx::Segment> segments(kPrimitivesPerFrame);
+  std::vector<gfx::Color32> colors(kPrimitivesPerFrame, gfx::Color32::kWhite);
+  state.SetItemsPerIteration(kPrimitivesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int p = 0; p < kPrimitivesPerFrame; ++p) {
+      segments[p] = {RandomPoint(), RandomPoint()};
+      colors[p] = common::rnd();
+    }
+    Gfx::Line(segments, colors);
+    Gfx::Flip();
+  }
+}
+
+void BM_FillRectBatch(State& state) {
+  std::vector<Gfx::Box> boxes(kPrimitivesPerFrame);
+  std::vector<gfx::Color32> colors(kPrimitivesPerFrame, gfx::Color32::kWhite);
+  state.SetItemsPerIteration(kPrimitivesPerFrame);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int p = 0; p < kPrimitivesPerFrame; ++p) {
+      boxes[p] = {RandomPoint(), {16, 16}};
+      colors[p] = common::rnd();
+    }
+    Gfx::FillRect(boxes, colors);
+    Gfx::Flip();
+  }
+}
+
+void BM_TextLine(State& state, int length, Gfx::TextHAlign h_align) {
+  const std::string text = RandomText(length);
+  state.SetItemsPerIteration(kTextPerFrame * length);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int t = 0; t < kTextPerFrame; ++t) {
+      Gfx::TextLine(text, {160, t * 12}, gfx::Color32::kWhite, h_align);
+    }
+    Gfx::Flip();
+  }
+}
+
+void BM_TextParagraph(State& state, int length, Gfx::TextHAlign h_align,
+                      Gfx::TextVAlign v_align) {
+  const std::string text = RandomText(length);
+  state.SetItemsPerIteration(length);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    Gfx::TextParagraph(text, {0, 0}, {319, 199}, gfx::Color32::kWhite, h_align,
+                       v_align);
+    Gfx::Flip();
+  }
+}
+
+// Fills the screen with debug text a line at a time, or as one paragraph.
+void BM_TextScreen(State& state, bool paragraph, bool deferred) {
+  const ivec2 res = Gfx::GetResolution();
+  const int columns = res.x / 8;
+  const int rows = res.y / 8;
+  const std::string text = RandomText(columns * rows);
+  state.SetItemsPerIteration(text.size());
+  Gfx::SetDeferred(deferred);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    if (paragraph) {
+      Gfx::TextParagraph(text, {0, 0}, res - ivec2{1, 1});
+    } else {
+      for (int r = 0; r < rows; ++r) {
+        Gfx::TextLine(std::string_view(text).substr(r * columns, columns),
+                      {0, r * 8});
+      }
+    }
+    Gfx::Flip();
+  }
+  Gfx::SetDeferred(false);
+}
+
+void BM_TextScreenCached(State& state) {
+  const ivec2 res = Gfx::GetResolution();
+  const std::string text = RandomText((res.x / 8) * (res.y / 8));
+  gfx::TextCache cache(4 * res.x * res.y);
+  state.SetItemsPerIteration(text.size());
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    cache.TextParagraph(text, {0, 0}, res - ivec2{1, 1});
+    Gfx::Flip();
+  }
+}
+
+}  // namespace
+
+void RegisterGfxBenchmarks() {
+  // Shared by the benchmarks and released along with them.
+  std::shared_ptr<gfx::Image> background =
+      gfx::Image::FromFile(kBackgroundFilename);
+  std::shared_ptr<gfx::Image> flakes = gfx::Image::FromFile(kFlakesFilename);
+
+  for (int b = 0; b < 4; ++b) {
+    const auto blend = static_cast<Gfx::PutOptions::BlendMode>(b);
+    const std::string suffix = std::string("/") + kBlendNames[b];
+    RegisterBenchmark("gfx/put_flake" + suffix, [flakes, blend](State& state) {
+      BM_PutFlake(state, *flakes, blend, false);
+    });
+    RegisterBenchmark("gfx/put_flake" + suffix + "/mod",
+                      [flakes, blend](State& state) {
+                        BM_PutFlake(state, *flakes, blend, true);
+                      });
+    RegisterBenchmark("gfx/put_background" + suffix,
+                      [background, blend](State& state) {
+                        BM_PutBackground(state, *background, blend);
+                      });
+  }
+
+  RegisterBenchmark("gfx/pset", BM_PSet);
+  RegisterBenchmark("gfx/pixels/pset", BM_PSetScreen);
+  RegisterBenchmark("gfx/pixels/lock", BM_LockScreen);
+  RegisterBenchmark("gfx/line", BM_Line);
+  RegisterBenchmark("gfx/fill_rect", BM_FillRect);
+  RegisterBenchmark("gfx/pset/batch", BM_PSetBatch);
+  RegisterBenchmark("gfx/line/batch", BM_LineBatch);
+  RegisterBenchmark("gfx/fill_rect/batch", BM_FillRectBatch);
+
+  const char* const kHAlignNames[] = {"left", "center", "right"};
+  const char* const kVAlignNames[] = {"top", "center", "bottom"};
+  for (int h = 0; h < 3; ++h) {
+    const auto h_align = static_cast<Gfx::TextHAlign>(h);
+    for (int length : {8, 32, 128}) {
+      RegisterBenchmark(
+          "gfx/text_line/" + std::to_string(length) + "/" + kHAlignNames[h],
+          [length, h_align](State& state) {
+            BM_TextLine(state, length, h_align);
+          });
+    }
+    for (int v = 0; v < 3; ++v) {
+      const auto v_align = static_cast<Gfx::TextVAlign>(v);
+      for (int length : {64, 512, 2048}) {
+        RegisterBenchmark("gfx/text_paragraph/" + std::to_string(length) +
+                              "/" + kHAlignNames[h] + "/" + kVAlignNames[v],
+                          [length, h_align, v_align](State& state) {
+                            BM_TextParagraph(state, length, h_align, v_align);
+                          });
+      }
+    }
+  }
+
+  for (const bool paragraph : {false, true}) {
+    for (const bool deferred : {false, true}) {
+      RegisterBenchmark(std::string("gfx/text_screen/") +
+                            (paragraph ? "paragraph" : "line") +
+                            (deferred ? "/deferred" : "/immediate"),
+                        [paragraph, deferred](State& state) {
+                          BM_TextScreen(state, paragraph, deferred);
+                        });
+    }
+  }
+  RegisterBenchmark("gfx/text_screen/paragraph/cached", BM_TextScreenCached);
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,71 @@
+// Benchmarks of common::JobSystem: the overhead of jobs, and how stepping a
+// large particle emitter scales from one thread to one per core.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "common/jobs.h"
+#include "game/particles.h"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+constexpr int kJobsPerIteration = 1000;
+constexpr int kParticleCount = 1000000;
+
+void BM_SubmitWait(State& state, int threads) {
+  common::JobSystem jobs(threads);
+  state.SetItemsPerIteration(kJobsPerIteration);
+  std::vector<common::JobHandle> handles(kJobsPerIteration);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (common::JobHandle& handle : handles) handle = jobs.Submit([] {});
+    jobs.Wait(handles);
+  }
+}
+
+void BM_ParticleStep(State& state, int threads) {
+  common::JobSystem jobs(threads);
+  game::ParticleEmitter::Params params;
+  params.vel = {1, 2};
+  params.jitter = 0.5;
+  params.bounds_min = {-324, -12};
+  params.bounds_max = {316, 204};
+  params.respawn_y = -4;
+  game::ParticleEmitter particles(kParticleCount, params, 0);
+  state.SetItemsPerIteration(kParticleCount);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) particles.Step(jobs);
+}
+
+}  // namespace
+
+void RegisterJobsBenchmarks() {
+  const int cores = std::max<int>(std::thread::hardware_concurrency(), 1);
+  std::vector<int> thread_counts;
+  for (int threads = 1; threads < cores; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(cores);
+
+  for (const int threads : thread_counts) {
+    const std::string suffix = "/" + std::to_string(threads);
+    RegisterBenchmark("jobs/submit_wait" + suffix, [threads](State& state) {
+      BM_SubmitWait(state, threads);
+    });
+    RegisterBenchmark("jobs/particle_step" + suffix, [threads](State& state) {
+      BM_ParticleStep(state, threads);
+    });
+  }
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,74 @@
+// Benchmarks of loading the images in res/ (as at startup), decoding PNGs
+// versus uploading from a memory mapped resource pack.
+
+#include <stdint.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "gfx/image.h"
+#include "gfx/pack.h"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+const std::vector<std::string> kImageFilenames = {
+    "res/flakes.png", "res/snowscreen.png", "res/system_font_.png",
+    "res/tiles.png"};
+
+void BM_LoadPng(State& state, const std::vector<std::string>& filenames) {
+  state.SetItemsPerIteration(filenames.size());
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (const std::string& filename : filenames) {
+      DoNotOptimize(gfx::Image::FromFile(filename).get());
+    }
+  }
+}
+
+// Includes opening the pack, as a cold start would.
+void BM_LoadPack(State& state, const std::string& pack_filename,
+                 const std::vector<std::string>& filenames) {
+  state.SetItemsPerIteration(filenames.size());
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const std::unique_ptr<gfx::ResourcePack> pack =
+        gfx::ResourcePack::Open(pack_filename);
+    for (const std::string& filename : filenames) {
+      DoNotOptimize(gfx::Image::FromPack(*pack, filename).get());
+    }
+  }
+}
+
+}  // namespace
+
+void RegisterLoadBenchmarks(const std::string& pack_filename) {
+  const bool have_pack = std::filesystem::exists(pack_filename);
+  LOG_IF(WARNING, !have_pack) << "No resource pack at " << pack_filename
+                              << ", skipping pack loading benchmarks.";
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> sets = {
+      {"all", kImageFilenames}};
+  for (const std::string& filename : kImageFilenames) {
+    sets.push_back(
+        {std::filesystem::path(filename).stem().string(), {filename}});
+  }
+  for (const auto& [name, filenames] : sets) {
+    RegisterBenchmark("load/png/" + name, [filenames](State& state) {
+      BM_LoadPng(state, filenames);
+    });
+    if (!have_pack) continue;
+    RegisterBenchmark("load/pack/" + name,
+                      [pack_filename, filenames](State& state) {
+                        BM_LoadPack(state, pack_filename, filenames);
+                      });
+  }
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,128 @@
+// Benchmarks of the PRNG in common/random.h.
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "common/random.h"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+constexpr int kCallsPerIteration = 1000;
+
+void BM_Rnd(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  uint64_t sum = 0;
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int c = 0; c < kCallsPerIteration; ++c) sum += common::rnd();
+  }
+  DoNotOptimize(sum);
+}
+
+void BM_Rndd(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  double sum = 0;
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int c = 0; c < kCallsPerIteration; ++c) sum += common::rndd();
+  }
+  DoNotOptimize(sum);
+}
+
+void BM_RnddRange(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  double sum = 0;
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int c = 0; c < kCallsPerIteration; ++c) {
+      sum += common::rndd(-0.5, 0.5);
+    }
+  }
+  DoNotOptimize(sum);
+}
+
+void BM_Rndf(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  float sum = 0;
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int c = 0; c < kCallsPerIteration; ++c) sum += common::rndf();
+  }
+  DoNotOptimize(sum);
+}
+
+// The bulk versions fill a buffer of kCallsPerIteration values, against
+// which the scalar calls above compare.
+
+void BM_RndFill(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  std::vector<uint64_t> values(kCallsPerIteration);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::rnd_fill(values.data(), values.size());
+    DoNotOptimize(values[0]);
+  }
+}
+
+void BM_RndFillBounded(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  std::vector<uint32_t> values(kCallsPerIteration);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::rnd_fill(values.data(), values.size(), 1000);
+    DoNotOptimize(values[0]);
+  }
+}
+
+void BM_RnddFill(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  std::vector<double> values(kCallsPerIteration);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::rndd_fill(values.data(), values.size());
+    DoNotOptimize(values[0]);
+  }
+}
+
+void BM_RnddFillRange(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  std::vector<double> values(kCallsPerIteration);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::rndd_fill(values.data(), values.size(), -0.5, 0.5);
+    DoNotOptimize(values[0]);
+  }
+}
+
+void BM_RndfFill(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  std::vector<float> values(kCallsPerIteration);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::rndf_fill(values.data(), values.size());
+    DoNotOptimize(values[0]);
+  }
+}
+
+void BM_RndfFillRange(State& state) {
+  state.SetItemsPerIteration(kCallsPerIteration);
+  std::vector<float> values(kCallsPerIteration);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::rndf_fill(values.data(), values.size(), -0.5f, 0.5f);
+    DoNotOptimize(values[0]);
+  }
+}
+
+}  // namespace
+
+void RegisterRandomBenchmarks() {
+  RegisterBenchmark("random/rnd", BM_Rnd);
+  RegisterBenchmark("random/rndd", BM_Rndd);
+  RegisterBenchmark("random/rndd_range", BM_RnddRange);
+  RegisterBenchmark("random/rndf", BM_Rndf);
+  RegisterBenchmark("random/fill/rnd", BM_RndFill);
+  RegisterBenchmark("random/fill/rnd_bounded", BM_RndFillBounded);
+  RegisterBenchmark("random/fill/rndd", BM_RnddFill);
+  RegisterBenchmark("random/fill/rndd_range", BM_RnddFillRange);
+  RegisterBenchmark("random/fill/rndf", BM_RndfFill);
+  RegisterBenchmark("random/fill/rndf_range", BM_RndfFillRange);
+}
+
+}  // namespace bench
+}  // namespace land15
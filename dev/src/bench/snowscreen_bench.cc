@@ -0,0 +1,54 @@
+// Benchmarks of stepping and drawing game::Snowscreen at increasing flake
+// counts.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "game/snowscreen.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+const std::string kFlakesFilename = "res/flakes.png";
+
+void BM_Step(State& state, int count) {
+  game::Snowscreen snow(count, {1, 2}, 0.5, 2);
+  state.SetItemsPerIteration(count);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) snow.Step();
+}
+
+void BM_Draw(State& state, const gfx::Image& flakes, int count) {
+  game::Snowscreen snow(count, {1, 2}, 0.5, 2);
+  state.SetItemsPerIteration(count);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    snow.Draw(flakes);
+    gfx::Gfx::Flip();
+  }
+}
+
+}  // namespace
+
+void RegisterSnowscreenBenchmarks() {
+  std::shared_ptr<gfx::Image> flakes = gfx::Image::FromFile(kFlakesFilename);
+  for (int count : {1000, 10000, 100000, 1000000}) {
+    const std::string suffix = "/" + std::to_string(count);
+    RegisterBenchmark("snowscreen/step" + suffix,
+                      [count](State& state) { BM_Step(state, count); });
+    RegisterBenchmark("snowscreen/draw" + suffix,
+                      [flakes, count](State& state) {
+                        BM_Draw(state, *flakes, count);
+                      });
+  }
+}
+
+}  // namespace bench
+}  // namespace land15
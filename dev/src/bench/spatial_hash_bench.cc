@@ -0,0 +1,162 @@
+// Benchmarks of common::SpatialHash at increasing object counts, with a
+// linear scan of the objects to compare the queries against.
+
+#include <stdint.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "common/random.h"
+#include "common/spatial_hash.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+using glm::vec2;
+
+constexpr float kCellSize = 16;
+constexpr float kObjectSize = 8;
+constexpr int kQueriesPerIteration = 1000;
+
+// The objects are spread over a square holding about one per cell, so that
+// the work per query stays the same at every count. The hash of them is built
+// on first use, and shared by the query benchmarks.
+struct World {
+  explicit World(int count)
+      : side(std::sqrt(static_cast<float>(count)) * kCellSize),
+        positions(count) {
+    common::RandomStream random(count);
+    for (vec2& p : positions) {
+      p = {random.NextFloat() * side, random.NextFloat() * side};
+    }
+  }
+
+  vec2 RandomPoint(common::RandomStream& random) const {
+    return {random.NextFloat() * side, random.NextFloat() * side};
+  }
+
+  void Fill(common::SpatialHash& hash) const {
+    for (const vec2& p : positions) hash.Insert(p, p + kObjectSize);
+  }
+
+  const common::SpatialHash& hash() {
+    if (hash_ == nullptr) {
+      hash_ = std::make_unique<common::SpatialHash>(kCellSize);
+      Fill(*hash_);
+    }
+    return *hash_;
+  }
+
+  const float side;
+  std::vector<vec2> positions;
+
+ private:
+  std::unique_ptr<common::SpatialHash> hash_;
+};
+
+// Builds a hash of every object, and frees it.
+void BM_Insert(State& state, const World& world) {
+  state.SetItemsPerIteration(world.positions.size());
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    common::SpatialHash hash(kCellSize);
+    world.Fill(hash);
+    DoNotOptimize(hash.size());
+  }
+}
+
+// Every object drifts a little, as the flakes of a Snowscreen do. Freeing the
+// hash is left out.
+void BM_Move(State& state, const World& world) {
+  common::SpatialHash hash(kCellSize);
+  world.Fill(hash);
+  std::vector<vec2> positions = world.positions;
+  state.SetItemsPerIteration(positions.size());
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const vec2 step = (i & 1) ? vec2(-1, 2) : vec2(1, -1);
+    for (int object = 0; object < positions.size(); ++object) {
+      vec2& p = positions[object];
+      p += step;
+      hash.Move(object, p, p + kObjectSize);
+    }
+  }
+  state.StopTimer();
+}
+
+// Finds the objects on a screen sized view.
+void BM_QueryScreen(State& state, World& world) {
+  const common::SpatialHash& hash = world.hash();
+  common::RandomStream random(1);
+  std::vector<common::SpatialHash::Handle> found;
+  state.SetItemsPerIteration(1);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const vec2 a = world.RandomPoint(random);
+    found.clear();
+    hash.Query(a, a + vec2(319, 199), found);
+    DoNotOptimize(found.size());
+  }
+}
+
+// Picks the objects under a point, like the mouse.
+void BM_QueryPoint(State& state, World& world) {
+  const common::SpatialHash& hash = world.hash();
+  common::RandomStream random(1);
+  std::vector<common::SpatialHash::Handle> found;
+  state.SetItemsPerIteration(kQueriesPerIteration);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    for (int q = 0; q < kQueriesPerIteration; ++q) {
+      found.clear();
+      hash.QueryPoint(world.RandomPoint(random), found);
+    }
+    DoNotOptimize(found.size());
+  }
+}
+
+// The same picking by testing every object.
+void BM_ScanPoint(State& state, const World& world) {
+  common::RandomStream random(1);
+  std::vector<int> found;
+  state.SetItemsPerIteration(1);
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const vec2 p = world.RandomPoint(random);
+    found.clear();
+    for (int object = 0; object < world.positions.size(); ++object) {
+      const vec2 a = world.positions[object];
+      if ((p.x >= a.x) && (p.y >= a.y) && (p.x <= a.x + kObjectSize) &&
+          (p.y <= a.y + kObjectSize)) {
+        found.push_back(object);
+      }
+    }
+    DoNotOptimize(found.size());
+  }
+}
+
+}  // namespace
+
+void RegisterSpatialHashBenchmarks() {
+  for (int count : {10000, 100000, 1000000}) {
+    auto world = std::make_shared<World>(count);
+    const std::string suffix = "/" + std::to_string(count);
+    RegisterBenchmark("spatial_hash/insert" + suffix,
+                      [world](State& state) { BM_Insert(state, *world); });
+    RegisterBenchmark("spatial_hash/move" + suffix,
+                      [world](State& state) { BM_Move(state, *world); });
+    RegisterBenchmark("spatial_hash/query_screen" + suffix,
+                      [world](State& state) { BM_QueryScreen(state, *world); });
+    RegisterBenchmark("spatial_hash/query_point" + suffix,
+                      [world](State& state) { BM_QueryPoint(state, *world); });
+    RegisterBenchmark("spatial_hash/scan_point" + suffix,
+                      [world](State& state) { BM_ScanPoint(state, *world); });
+  }
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,125 @@
+// Benchmarks of drawing a game::TileMap, against drawing the same tiles with a
+// Put each.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "bench/bench.h"
+#include "bench/benchmarks.h"
+#include "common/random.h"
+#include "game/tilemap.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace bench {
+namespace {
+
+using gfx::Gfx;
+using glm::ivec2;
+
+const std::string kTilesFilename = "res/tiles.png";
+
+constexpr int kTileDim = 16;
+// Tiles in res/tiles.png.
+constexpr int kTileCount = 19;
+// Width and height of the benchmark map in tiles.
+constexpr int kMapDim = 256;
+
+// Tile at `p` of a map that's the same on every run.
+uint16_t MapTile(ivec2 p) {
+  return static_cast<uint16_t>((p.x * 7 + p.y * 13 + (p.x ^ p.y)) %
+                               kTileCount);
+}
+
+// The camera pans diagonally across the map, one pixel per frame.
+ivec2 Camera(int64_t frame) {
+  const int span = kMapDim * kTileDim - Gfx::GetResolution().x;
+  return ivec2(static_cast<int>(frame % span));
+}
+
+std::unique_ptr<game::TileMap> MakeMap(const gfx::Image& tiles) {
+  auto map = std::make_unique<game::TileMap>(tiles, game::TileMap::Options());
+  for (int y = 0; y < kMapDim; ++y) {
+    for (int x = 0; x < kMapDim; ++x) map->Set({x, y}, MapTile({x, y}));
+  }
+  return map;
+}
+
+void BM_DrawPerTile(State& state, const gfx::Image& tiles) {
+  const ivec2 res = Gfx::GetResolution();
+  const int columns = tiles.width() / kTileDim;
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const ivec2 camera = Camera(i);
+    const ivec2 lo = camera / kTileDim;
+    const ivec2 hi = (camera + res - 1) / kTileDim;
+    for (int y = lo.y; y <= hi.y; ++y) {
+      for (int x = lo.x; x <= hi.x; ++x) {
+        const uint16_t tile = MapTile({x, y});
+        const ivec2 src_a =
+            ivec2(tile % columns, tile / columns) * kTileDim;
+        Gfx::Put(tiles, ivec2(x, y) * kTileDim - camera, src_a,
+                 src_a + kTileDim - 1);
+      }
+    }
+    Gfx::Flip();
+  }
+}
+
+void BM_DrawCached(State& state, const gfx::Image& tiles) {
+  std::unique_ptr<game::TileMap> map = MakeMap(tiles);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    map->Draw(Camera(i));
+    Gfx::Flip();
+  }
+}
+
+// Changes a visible tile every frame, re-rendering its chunk.
+void BM_DrawEdited(State& state, const gfx::Image& tiles) {
+  std::unique_ptr<game::TileMap> map = MakeMap(tiles);
+  state.ResetTimer();
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    const ivec2 camera = Camera(i);
+    map->Set(camera / kTileDim, common::rnd() % kTileCount);
+    map->Draw(camera);
+    Gfx::Flip();
+  }
+}
+
+// Streams the map in from a loader, keeping only a handful of chunks.
+void BM_DrawStreamed(State& state, const gfx::Image& tiles) {
+  game::TileMap::Options options;
+  options.max_textures = 8;
+  options.max_chunks = 8;
+  game::TileMap map(tiles, options, [&options](ivec2 chunk, uint16_t* out) {
+    const int n = options.chunk_tiles;
+    for (int y = 0; y < n; ++y) {
+      for (int x = 0; x < n; ++x) *out++ = MapTile(chunk * n + ivec2(x, y));
+    }
+  });
+  for (int64_t i = 0; i < state.iterations(); ++i) {
+    map.Draw(Camera(i));
+    Gfx::Flip();
+  }
+}
+
+}  // namespace
+
+void RegisterTileMapBenchmarks() {
+  std::shared_ptr<gfx::Image> tiles = gfx::Image::FromFile(kTilesFilename);
+  RegisterBenchmark("tilemap/draw_per_tile",
+                    [tiles](State& state) { BM_DrawPerTile(state, *tiles); });
+  RegisterBenchmark("tilemap/draw_cached",
+                    [tiles](State& state) { BM_DrawCached(state, *tiles); });
+  RegisterBenchmark("tilemap/draw_edited",
+                    [tiles](State& state) { BM_DrawEdited(state, *tiles); });
+  RegisterBenchmark("tilemap/draw_streamed",
+                    [tiles](State& state) { BM_DrawStreamed(state, *tiles); });
+}
+
+}  // namespace bench
+}  // namespace land15
@@ -0,0 +1,176 @@
+#include "common/jobs.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace land15 {
+namespace common {
+
+namespace {
+
+// The system and queue of the worker running on this thread, if any.
+thread_local const JobSystem* worker_system = nullptr;
+thread_local int worker_index = -1;
+
+}  // namespace
+
+JobSystem::JobSystem(int threads) {
+  if (threads == 0) {
+    threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+  }
+  CHECK_GT(threads, 0) << "JobSystem needs at least one thread.";
+  for (int i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int i = 0; i < threads - 1; ++i) {
+    workers_.emplace_back([this, i] { Work(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_cv_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+int JobSystem::QueueIndex() const {
+  return (worker_system == this) ? worker_index : workers_.size();
+}
+
+JobHandle JobSystem::Submit(std::function<void()> fn,
+                            const std::vector<JobHandle>& deps) {
+  JobHandle job(new Job(std::move(fn)));
+  for (const JobHandle& dep : deps) {
+    std::lock_guard<std::mutex> lock(dep->mutex_);
+    if (dep->done()) continue;
+    job->unfinished_.fetch_add(1, std::memory_order_relaxed);
+    dep->dependents_.push_back(job);
+  }
+  // Drop the submission's count, scheduling the job unless a dependency still
+  // has to.
+  if (job->unfinished_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Schedule(job);
+  }
+  return job;
+}
+
+void JobSystem::Schedule(JobHandle job) {
+  Queue& queue = *queues_[QueueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  {
+    // Counted under the sleep lock so a worker can't miss the wake up.
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  wake_cv_.notify_one();
+}
+
+JobHandle JobSystem::Take() {
+  const int own = QueueIndex();
+  {
+    Queue& queue = *queues_[own];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.jobs.empty()) {
+      JobHandle job = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  for (int i = 1; i < queues_.size(); ++i) {
+    Queue& queue = *queues_[(own + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.jobs.empty()) {
+      JobHandle job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::Run(const JobHandle& job) {
+  job->fn_();
+  job->fn_ = nullptr;
+
+  std::vector<JobHandle> dependents;
+  {
+    std::lock_guard<std::mutex> lock(job->mutex_);
+    job->done_.store(true, std::memory_order_release);
+    dependents.swap(job->dependents_);
+  }
+  for (JobHandle& dependent : dependents) {
+    if (dependent->unfinished_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Schedule(std::move(dependent));
+    }
+  }
+}
+
+void JobSystem::Work(int index) {
+  worker_system = this;
+  worker_index = index;
+  while (true) {
+    if (JobHandle job = Take()) {
+      Run(job);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_cv_.wait(lock, [this] {
+      return stopping_ || (queued_.load(std::memory_order_relaxed) > 0);
+    });
+    if (stopping_) return;
+  }
+}
+
+void JobSystem::Wait(const JobHandle& job) {
+  while (!job->done()) {
+    if (JobHandle other = Take()) {
+      Run(other);
+    } else {
+      // What's left is running on other threads.
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::Wait(const std::vector<JobHandle>& jobs) {
+  for (const JobHandle& job : jobs) Wait(job);
+}
+
+void JobSystem::ParallelFor(int64_t begin, int64_t end, int64_t grain,
+                            const std::function<void(int64_t, int64_t)>& fn) {
+  CHECK_GT(grain, 0) << "ParallelFor needs a positive grain.";
+  if (begin >= end) return;
+  if (end - begin <= grain) {
+    fn(begin, end);
+    return;
+  }
+  std::vector<JobHandle> jobs;
+  jobs.reserve((end - begin + grain - 1) / grain);
+  // The calling thread takes the first range itself.
+  for (int64_t lo = begin + grain; lo < end; lo += grain) {
+    const int64_t hi = std::min(lo + grain, end);
+    jobs.push_back(Submit([&fn, lo, hi] { fn(lo, hi); }));
+  }
+  fn(begin, std::min(begin + grain, end));
+  Wait(jobs);
+}
+
+}  // namespace common
+}  // namespace land15
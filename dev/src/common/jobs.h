@@ -0,0 +1,114 @@
+#ifndef LAND15_COMMON_JOBS_H_
+#define LAND15_COMMON_JOBS_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace land15 {
+namespace common {
+
+class JobSystem;
+
+// A unit of work submitted to a JobSystem.
+class Job {
+ public:
+  Job(const Job&) = delete;
+  Job& operator=(const Job&) = delete;
+
+  // True once the job has run.
+  bool done() const { return done_.load(std::memory_order_acquire); }
+
+ private:
+  friend class JobSystem;
+  explicit Job(std::function<void()> fn) : fn_(std::move(fn)) {}
+
+  std::function<void()> fn_;
+  std::atomic<bool> done_ = false;
+  // Dependencies not yet done, plus one while the job is being submitted.
+  std::atomic<int> unfinished_ = 1;
+
+  // Jobs waiting on this one, guarded by `mutex_` until this one is done.
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<Job>> dependents_;
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+// A pool of threads running jobs, each thread keeping its own queue and
+// stealing from the others' once it runs dry. A thread pushes the jobs it
+// submits to its own queue and takes the newest first, while thieves take the
+// oldest, which keeps related work on the same thread and splits the rest in
+// large pieces.
+//
+// Threads waiting on a job run other jobs in the meantime, so jobs may
+// themselves submit and wait on jobs.
+class JobSystem {
+ public:
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Runs jobs on `threads` threads, counting the thread that waits on them: a
+  // single thread only runs jobs as they are waited on. Zero means one thread
+  // per core.
+  explicit JobSystem(int threads = 0);
+  ~JobSystem();
+
+  // Queues `fn` to run once every job of `deps` has run.
+  JobHandle Submit(std::function<void()> fn,
+                   const std::vector<JobHandle>& deps = {});
+
+  // Runs jobs until `job` is done.
+  void Wait(const JobHandle& job);
+  void Wait(const std::vector<JobHandle>& jobs);
+
+  // Calls `fn` over `[begin, end)` split into ranges of `grain` elements (the
+  // last one possibly shorter), in parallel, and returns once every call has
+  // returned. Smaller grains balance better but cost more overhead.
+  void ParallelFor(int64_t begin, int64_t end, int64_t grain,
+                   const std::function<void(int64_t, int64_t)>& fn);
+
+  // The number of threads jobs run on, counting the one waiting on them.
+  int thread_count() const { return workers_.size() + 1; }
+
+ private:
+  // A thread's queue of jobs ready to run.
+  struct Queue {
+    std::mutex mutex;
+    std::deque<JobHandle> jobs;
+  };
+
+  // The queue of the calling thread: its own if it's one of the workers, else
+  // the one shared by every other thread.
+  int QueueIndex() const;
+
+  // Queues a job whose dependencies are all done.
+  void Schedule(JobHandle job);
+  // Takes a job from the calling thread's queue, or steals one. Returns null
+  // if there's nothing to run.
+  JobHandle Take();
+  void Run(const JobHandle& job);
+  void Work(int index);
+
+  // One per worker, then the shared one.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  // Workers sleep on `wake_cv_` while nothing is queued.
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_cv_;
+  std::atomic<int> queued_ = 0;
+  bool stopping_ = false;
+};
+
+}  // namespace common
+}  // namespace land15
+
+#endif  // LAND15_COMMON_JOBS_H_
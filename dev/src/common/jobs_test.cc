@@ -0,0 +1,103 @@
+#include "common/jobs.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace common {
+namespace {
+
+class JobsTest : public testing::TestWithParam<int> {};
+
+TEST_P(JobsTest, SubmitRunsAfterDependencies) {
+  JobSystem jobs(GetParam());
+  for (int round = 0; round < 50; ++round) {
+    std::mutex mutex;
+    std::vector<char> order;
+    auto record = [&](char name) {
+      return [&, name] {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+      };
+    };
+    // A diamond, with a slow branch so the join really has to wait on it.
+    const JobHandle a = jobs.Submit([&] {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      record('a')();
+    });
+    const JobHandle b = jobs.Submit(record('b'));
+    const JobHandle c = jobs.Submit(record('c'), {a, b});
+    const JobHandle d = jobs.Submit(record('d'), {c});
+    jobs.Wait(d);
+
+    ASSERT_EQ(order.size(), 4);
+    EXPECT_EQ(order[2], 'c');
+    EXPECT_EQ(order[3], 'd');
+    EXPECT_TRUE(a->done() && b->done() && c->done() && d->done());
+  }
+}
+
+TEST_P(JobsTest, WaitOnDoneJobs) {
+  JobSystem jobs(GetParam());
+  int runs = 0;
+  const JobHandle job = jobs.Submit([&runs] { ++runs; });
+  jobs.Wait(job);
+  ASSERT_TRUE(job->done());
+
+  // Waiting again returns at once, and depending on it doesn't block.
+  jobs.Wait(job);
+  jobs.Wait({job, job});
+  const JobHandle after = jobs.Submit([&runs] { ++runs; }, {job});
+  jobs.Wait(after);
+  EXPECT_EQ(runs, 2);
+}
+
+TEST_P(JobsTest, ParallelForCoversRange) {
+  JobSystem jobs(GetParam());
+  constexpr int kCount = 10007;
+  std::vector<std::atomic<int>> hits(kCount);
+  jobs.ParallelFor(0, kCount, 64, [&hits](int64_t lo, int64_t hi) {
+    for (int64_t i = lo; i < hi; ++i) hits[i].fetch_add(1);
+  });
+  for (int i = 0; i < kCount; ++i) ASSERT_EQ(hits[i].load(), 1) << i;
+
+  // Empty and single range loops.
+  int calls = 0;
+  jobs.ParallelFor(5, 5, 1, [&calls](int64_t, int64_t) { ++calls; });
+  jobs.ParallelFor(0, 10, 100, [&calls](int64_t lo, int64_t hi) {
+    EXPECT_EQ(lo, 0);
+    EXPECT_EQ(hi, 10);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_P(JobsTest, NestedParallelFor) {
+  JobSystem jobs(GetParam());
+  constexpr int kOuter = 16;
+  constexpr int kInner = 1000;
+  std::vector<std::atomic<int>> hits(kOuter * kInner);
+  jobs.ParallelFor(0, kOuter, 1, [&](int64_t outer_lo, int64_t outer_hi) {
+    for (int64_t outer = outer_lo; outer < outer_hi; ++outer) {
+      jobs.ParallelFor(0, kInner, 50, [&, outer](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; ++i) {
+          hits[outer * kInner + i].fetch_add(1);
+        }
+      });
+    }
+  });
+  for (int i = 0; i < kOuter * kInner; ++i) ASSERT_EQ(hits[i].load(), 1) << i;
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, JobsTest, testing::Values(1, 2, 4));
+
+}  // namespace
+}  // namespace common
+}  // namespace land15
@@ -0,0 +1,83 @@
+#include "common/mapped_file.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "glog/logging.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace land15 {
+namespace common {
+
+#ifdef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& filename) {
+  std::unique_ptr<MappedFile> file(new MappedFile());
+  file->file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  CHECK_NE(file->file_, INVALID_HANDLE_VALUE)
+      << "Win32 error (CreateFileA): " << GetLastError() << " opening "
+      << filename;
+  LARGE_INTEGER size;
+  CHECK(GetFileSizeEx(file->file_, &size))
+      << "Win32 error (GetFileSizeEx): " << GetLastError();
+  file->size_ = size.QuadPart;
+  if (file->size_ == 0) return file;
+
+  file->mapping_ =
+      CreateFileMappingA(file->file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CHECK_NE(file->mapping_, static_cast<void*>(nullptr))
+      << "Win32 error (CreateFileMappingA): " << GetLastError();
+  file->data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(file->mapping_, FILE_MAP_READ, 0, 0, 0));
+  CHECK_NE(file->data_, static_cast<const uint8_t*>(nullptr))
+      << "Win32 error (MapViewOfFile): " << GetLastError();
+  return file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) UnmapViewOfFile(data_);
+  if (mapping_ != nullptr) CloseHandle(mapping_);
+  if ((file_ != nullptr) && (file_ != INVALID_HANDLE_VALUE)) CloseHandle(file_);
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& filename) {
+  std::unique_ptr<MappedFile> file(new MappedFile());
+  const int fd = open(filename.c_str(), O_RDONLY);
+  PCHECK(fd != -1) << "Error (open) opening " << filename;
+  struct stat st;
+  PCHECK(fstat(fd, &st) == 0) << "Error (fstat)";
+  file->size_ = st.st_size;
+  if (file->size_ > 0) {
+    void* data = mmap(nullptr, file->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    PCHECK(data != MAP_FAILED) << "Error (mmap)";
+    file->data_ = static_cast<const uint8_t*>(data);
+  }
+  close(fd);
+  return file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+#endif
+
+}  // namespace common
+}  // namespace land15
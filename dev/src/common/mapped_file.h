@@ -0,0 +1,41 @@
+#ifndef LAND15_COMMON_MAPPED_FILE_H_
+#define LAND15_COMMON_MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+namespace land15 {
+namespace common {
+
+// A read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Maps `filename`, which must exist.
+  static std::unique_ptr<MappedFile> Open(const std::string& filename);
+
+  ~MappedFile();
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile() = default;
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace common
+}  // namespace land15
+
+#endif  // LAND15_COMMON_MAPPED_FILE_H_
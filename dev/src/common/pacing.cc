@@ -0,0 +1,32 @@
+#include "common/pacing.h"
+
+#include <chrono>
+#include <thread>
+
+namespace land15 {
+namespace common {
+
+using Clock = std::chrono::steady_clock;
+
+void WaitUntil(Clock::time_point deadline, WaitStrategy strategy,
+               std::chrono::nanoseconds spin_margin) {
+  switch (strategy) {
+    case kWaitSleep:
+      std::this_thread::sleep_until(deadline);
+      return;
+    case kWaitHybrid:
+      // Each sleep can overshoot by a scheduler quantum, so sleep a
+      // millisecond at a time and re-check.
+      while (deadline - Clock::now() > spin_margin) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      [[fallthrough]];
+    case kWaitSpin:
+      while (Clock::now() < deadline) {
+      }
+      return;
+  }
+}
+
+}  // namespace common
+}  // namespace land15
@@ -0,0 +1,28 @@
+#ifndef LAND15_COMMON_PACING_H_
+#define LAND15_COMMON_PACING_H_
+
+#include <chrono>
+
+namespace land15 {
+namespace common {
+
+enum WaitStrategy {
+  // Sleeps, which is cheap but only as precise as the OS scheduler (as coarse
+  // as 15.6ms on Windows by default).
+  kWaitSleep = 0,
+  // Spins for the whole wait: precise, but burns a core.
+  kWaitSpin = 1,
+  // Sleeps in short steps until close to the deadline, then spins the rest.
+  kWaitHybrid = 2
+};
+
+// Waits until `deadline`. With kWaitHybrid, sleeping stops once less than
+// `spin_margin` is left.
+void WaitUntil(
+    std::chrono::steady_clock::time_point deadline, WaitStrategy strategy,
+    std::chrono::nanoseconds spin_margin = std::chrono::milliseconds(2));
+
+}  // namespace common
+}  // namespace land15
+
+#endif  // LAND15_COMMON_PACING_H_
@@ -1,34 +1,41 @@
 #include "common/random.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <functional>
-#include <limits>
+#include <optional>
 #include <thread>
 
+#include "glog/logging.h"
+
 namespace land15 {
 namespace common {
 namespace {
 
+// One step of xorshift128+, shared by every generator here.
+inline uint64_t XorShiftStep(uint64_t& s0, uint64_t& s1) {
+  uint64_t x = s0;
+  const uint64_t y = s1;
+  s0 = y;
+
+  x ^= x << 23;
+  x ^= x >> 17;
+  x ^= y ^ (y >> 26);
+
+  s1 = x;
+
+  return x + y;
+}
+
 struct XorShiftP {
   XorShiftP() {
     srnd(std::hash<std::thread::id>{}(std::this_thread::get_id()));
   }
   uint64_t state[2];
 
-  uint64_t Step() {
-    uint64_t x = state[0];
-    const uint64_t y = state[1];
-    state[0] = y;
-
-    x ^= x << 23;
-    x ^= x >> 17;
-    x ^= y ^ (y >> 26);
-
-    state[1] = x;
-
-    return x + y;
-  }
+  uint64_t Step() { return XorShiftStep(state[0], state[1]); }
 
   void Seed(uint64_t s) {
     state[0] = s;
@@ -38,19 +45,196 @@ struct XorShiftP {
 };
 thread_local XorShiftP prng;
 
+// The bulk functions' stream, created on first use.
+thread_local std::optional<RandomStream> thread_stream;
+
+RandomStream& ThreadStream() {
+  if (!thread_stream) thread_stream.emplace(rnd());
+  return *thread_stream;
+}
+
+// SplitMix64, to spread a seed over the generator state.
+uint64_t MixSeed(uint64_t& s) {
+  uint64_t z = (s += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+// Values generated at a time by the bulk functions before converting them.
+constexpr size_t kBlock = 32 * RandomStream::kLanes;
+
 }  // namespace
 
-uint64_t rnd() { return prng.Step(); }
+namespace internal {
 
-double rndd() {
-  return static_cast<double>(rnd()) / std::numeric_limits<uint64_t>::max();
+// The coefficients of x^(2^64) modulo the characteristic polynomial of the
+// generator (with shifts 23, 17 and 26), lowest first.
+constexpr uint64_t kJump[] = {0x8c405782bca686ad, 0xc44f35946fef49c6};
+
+void JumpState(uint64_t& s0, uint64_t& s1) {
+  uint64_t j0 = 0;
+  uint64_t j1 = 0;
+  for (const uint64_t word : kJump) {
+    for (int b = 0; b < 64; ++b) {
+      if (word & (uint64_t{1} << b)) {
+        j0 ^= s0;
+        j1 ^= s1;
+      }
+      XorShiftStep(s0, s1);
+    }
+  }
+  s0 = j0;
+  s1 = j1;
 }
 
+}  // namespace internal
+
+uint64_t rnd() { return prng.Step(); }
+
+double rndd() { return BitsToUnitDouble(rnd() >> 12); }
+
 double rndd(double start_inc, double end_ex) {
   return rndd() * (end_ex - start_inc) + start_inc;
 }
 
-void srnd(uint64_t s) { prng.Seed(s); }
+float rndf() { return BitsToUnitFloat(rnd() >> 41); }
+
+void srnd(uint64_t s) {
+  prng.Seed(s);
+  // Reseeded from the new stream on next use.
+  thread_stream.reset();
+}
+
+void rnd_fill(uint64_t* out, size_t n) { ThreadStream().Fill(out, n); }
+
+void rndf_fill(float* out, size_t n) { ThreadStream().Fill(out, n, 0, 1); }
+
+void rndf_fill(float* out, size_t n, float start_inc, float end_ex) {
+  ThreadStream().Fill(out, n, start_inc, end_ex);
+}
+
+void rndd_fill(double* out, size_t n) { ThreadStream().Fill(out, n, 0, 1); }
+
+void rndd_fill(double* out, size_t n, double start_inc, double end_ex) {
+  ThreadStream().Fill(out, n, start_inc, end_ex);
+}
+
+void rnd_fill(uint32_t* out, size_t n, uint32_t bound) {
+  ThreadStream().Fill(out, n, bound);
+}
+
+RandomStream::RandomStream(uint64_t seed) {
+  state0_[0] = MixSeed(seed);
+  // The state must never be all zero.
+  state1_[0] = MixSeed(seed) | 1;
+  for (int i = 1; i < kLanes; ++i) {
+    state0_[i] = state0_[i - 1];
+    state1_[i] = state1_[i - 1];
+    internal::JumpState(state0_[i], state1_[i]);
+  }
+}
+
+RandomStream RandomStream::Split() {
+  RandomStream split = *this;
+  for (int i = 0; i < kLanes; ++i) Jump();
+  next_ = kLanes;
+  return split;
+}
+
+void RandomStream::Jump() {
+  for (int i = 0; i < kLanes; ++i) {
+    internal::JumpState(state0_[i], state1_[i]);
+  }
+}
+
+uint64_t RandomStream::Next() {
+  if (next_ == kLanes) {
+    FillRows(row_, 1);
+    next_ = 0;
+  }
+  return row_[next_++];
+}
+
+void RandomStream::FillRows(uint64_t* out, size_t rows) {
+  // Worked on in locals so the state stays in registers.
+  uint64_t s0[kLanes];
+  uint64_t s1[kLanes];
+  std::copy(state0_, state0_ + kLanes, s0);
+  std::copy(state1_, state1_ + kLanes, s1);
+  for (size_t row = 0; row < rows; ++row, out += kLanes) {
+    for (int i = 0; i < kLanes; ++i) out[i] = XorShiftStep(s0[i], s1[i]);
+  }
+  std::copy(s0, s0 + kLanes, state0_);
+  std::copy(s1, s1 + kLanes, state1_);
+}
+
+void RandomStream::FillValues(uint64_t* out, size_t n) {
+  const size_t rows = n / kLanes;
+  FillRows(out, rows);
+  for (size_t i = rows * kLanes; i < n; ++i) out[i] = Next();
+}
+
+void RandomStream::Fill(uint64_t* out, size_t n) { FillValues(out, n); }
+
+void RandomStream::Fill(float* out, size_t n, float start_inc, float end_ex) {
+  const float scale = end_ex - start_inc;
+  uint64_t block[kBlock];
+  while (n > 0) {
+    // Two floats from each 64bit value.
+    const size_t count = std::min(n, kBlock * 2);
+    FillValues(block, (count + 1) / 2);
+    const size_t pairs = count / 2;
+    for (size_t i = 0; i < pairs; ++i) {
+      out[i * 2] = BitsToUnitFloat(block[i] >> 41) * scale + start_inc;
+      out[i * 2 + 1] = BitsToUnitFloat(block[i] >> 9) * scale + start_inc;
+    }
+    if (count & 1) {
+      out[count - 1] = BitsToUnitFloat(block[pairs] >> 41) * scale + start_inc;
+    }
+    out += count;
+    n -= count;
+  }
+}
+
+void RandomStream::Fill(double* out, size_t n, double start_inc,
+                        double end_ex) {
+  const double scale = end_ex - start_inc;
+  uint64_t block[kBlock];
+  while (n > 0) {
+    const size_t count = std::min(n, kBlock);
+    FillValues(block, count);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = BitsToUnitDouble(block[i] >> 12) * scale + start_inc;
+    }
+    out += count;
+    n -= count;
+  }
+}
+
+void RandomStream::Fill(uint32_t* out, size_t n, uint32_t bound) {
+  CHECK_GT(bound, 0) << "Can't draw ints below a bound of 0.";
+  // Lemire's multiply and shift: the high half of the 64bit product of 32
+  // random bits and `bound` is in [0, bound), and is unbiased once the rare
+  // products whose low half is below `threshold` are redrawn.
+  const uint32_t threshold = (0 - bound) % bound;
+  uint64_t block[kBlock];
+  while (n > 0) {
+    // Two ints from each 64bit value.
+    const size_t count = std::min(n, kBlock * 2);
+    FillValues(block, (count + 1) / 2);
+    for (size_t i = 0; i < count; ++i) {
+      const uint32_t bits = block[i / 2] >> ((i & 1) * 32);
+      uint64_t m = uint64_t{bits} * bound;
+      while (static_cast<uint32_t>(m) < threshold) {
+        m = (Next() >> 32) * bound;
+      }
+      out[i] = m >> 32;
+    }
+    out += count;
+    n -= count;
+  }
+}
 
 }  // namespace common
 }  // namespace land15
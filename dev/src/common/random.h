@@ -1,7 +1,9 @@
 #ifndef LAND15_COMMON_RANDOM_H_
 #define LAND15_COMMON_RANDOM_H_
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 namespace land15 {
 namespace common {
@@ -17,10 +19,98 @@ double rndd();
 // `rnd()`.
 double rndd(double start_inc, double end_ex);
 
+// Produces a pseudo-random float in the range `[0, 1)`. Uses rnd().
+float rndf();
+
 // Provide a specific seed to the PRNG in the current thread. A given seed will
-// always produce the same stream of random values.
+// always produce the same stream of random values, bulk ones included.
 void srnd(uint64_t s);
 
+// Bulk versions of the above, which fill `n` values at `out`. They draw from a
+// per-thread RandomStream seeded from rnd() on first use, which generates
+// several values at a time. Prefer them whenever more than a handful of values
+// are needed at once.
+void rnd_fill(uint64_t* out, size_t n);
+void rndf_fill(float* out, size_t n);
+void rndf_fill(float* out, size_t n, float start_inc, float end_ex);
+void rndd_fill(double* out, size_t n);
+void rndd_fill(double* out, size_t n, double start_inc, double end_ex);
+
+// Fills `n` unbiased pseudo-random ints in the range `[0, bound)`.
+void rnd_fill(uint32_t* out, size_t n, uint32_t bound);
+
+// Maps the low 23 bits of `bits` to a float in `[0, 1)`, by using them as the
+// mantissa of a float in `[1, 2)`.
+inline float BitsToUnitFloat(uint32_t bits) {
+  const uint32_t one_to_two = 0x3f800000 | (bits & 0x7fffff);
+  float f;
+  memcpy(&f, &one_to_two, sizeof(f));
+  return f - 1.0f;
+}
+
+// Maps the low 52 bits of `bits` to a double in `[0, 1)`, as above.
+inline double BitsToUnitDouble(uint64_t bits) {
+  const uint64_t one_to_two = 0x3ff0000000000000 | (bits & 0xfffffffffffff);
+  double d;
+  memcpy(&d, &one_to_two, sizeof(d));
+  return d - 1.0;
+}
+
+// A stream of pseudo-random values that depends only on its seed, for work
+// that has to reproduce exactly, like simulation spread across threads.
+//
+// It runs kLanes xorshift128+ generators side by side (which vectorizes), each
+// on its own stretch of 2^64 values of the sequence started by the seed.
+// Split() hands out streams made of the stretches that follow, so no two
+// streams split in turn from the same stream ever share a value. Giving each
+// piece of work (rather than each thread) its own stream makes the results
+// the same whatever thread, or number of threads, runs it.
+class RandomStream {
+ public:
+  static constexpr int kLanes = 8;
+
+  explicit RandomStream(uint64_t seed);
+
+  // Returns a copy of this stream, and moves this one past every value the
+  // copy can produce. Streams split from a split stream may overlap with its
+  // siblings, so all the streams of a job should be split from one stream.
+  RandomStream Split();
+
+  uint64_t Next();
+  // In `[0, 1)`.
+  float NextFloat() { return BitsToUnitFloat(Next() >> 41); }
+  double NextDouble() { return BitsToUnitDouble(Next() >> 12); }
+
+  // Like the rnd*_fill functions, drawing from this stream.
+  void Fill(uint64_t* out, size_t n);
+  void Fill(float* out, size_t n, float start_inc, float end_ex);
+  void Fill(double* out, size_t n, double start_inc, double end_ex);
+  void Fill(uint32_t* out, size_t n, uint32_t bound);
+
+ private:
+  // Advances every lane by 2^64 values.
+  void Jump();
+
+  // Writes `rows` values per lane to `out`, a row of one per lane at a time.
+  void FillRows(uint64_t* out, size_t rows);
+  // Writes any `n` values to `out`.
+  void FillValues(uint64_t* out, size_t n);
+
+  alignas(64) uint64_t state0_[kLanes];
+  alignas(64) uint64_t state1_[kLanes];
+
+  // A row generated for Next(), of which `next_` is the first unused value.
+  uint64_t row_[kLanes];
+  int next_ = kLanes;
+};
+
+namespace internal {
+
+// Advances a xorshift128+ state by 2^64 steps.
+void JumpState(uint64_t& s0, uint64_t& s1);
+
+}  // namespace internal
+
 }  // namespace common
 }  // namespace chime
 
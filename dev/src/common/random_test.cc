@@ -0,0 +1,182 @@
+#include "common/random.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace common {
+namespace {
+
+// A xorshift128+ state as a vector over GF(2), s0 in the low word.
+struct State {
+  uint64_t s0;
+  uint64_t s1;
+
+  bool operator==(const State& other) const {
+    return (s0 == other.s0) && (s1 == other.s1);
+  }
+};
+
+// The state transition of xorshift128+ with shifts 23, 17 and 26, written out
+// independently of random.cc.
+State Step(State s) {
+  uint64_t x = s.s0;
+  const uint64_t y = s.s1;
+  x ^= x << 23;
+  x ^= x >> 17;
+  x ^= y ^ (y >> 26);
+  return {y, x};
+}
+
+// A linear map over GF(2)^128, as the image of each basis vector.
+using Matrix = std::array<State, 128>;
+
+State Apply(const Matrix& m, State s) {
+  State out{0, 0};
+  for (int bit = 0; bit < 128; ++bit) {
+    const uint64_t word = (bit < 64) ? s.s0 : s.s1;
+    if (!((word >> (bit % 64)) & 1)) continue;
+    out.s0 ^= m[bit].s0;
+    out.s1 ^= m[bit].s1;
+  }
+  return out;
+}
+
+Matrix Square(const Matrix& m) {
+  Matrix out;
+  for (int bit = 0; bit < 128; ++bit) out[bit] = Apply(m, m[bit]);
+  return out;
+}
+
+// The transition matrix raised to 2^`log2_steps`.
+Matrix StepPower(int log2_steps) {
+  Matrix m;
+  for (int bit = 0; bit < 128; ++bit) {
+    const State basis{(bit < 64) ? uint64_t{1} << bit : 0,
+                      (bit < 64) ? 0 : uint64_t{1} << (bit - 64)};
+    m[bit] = Step(basis);
+  }
+  for (int i = 0; i < log2_steps; ++i) m = Square(m);
+  return m;
+}
+
+constexpr State kStates[] = {{1, 0},
+                             {0, 1},
+                             {0x0123456789abcdef, 0xfedcba9876543210},
+                             {0x5ea34222ef71888b, 0x9e3779b97f4a7c15}};
+
+TEST(RandomTest, StepPowerMatchesStepping) {
+  const Matrix m = StepPower(10);
+  for (State s : kStates) {
+    const State expected = Apply(m, s);
+    for (int i = 0; i < 1024; ++i) s = Step(s);
+    EXPECT_TRUE(s == expected);
+  }
+}
+
+TEST(RandomTest, JumpStateIsTwoToThe64Steps) {
+  const Matrix jump = StepPower(64);
+  for (const State s : kStates) {
+    State jumped = s;
+    internal::JumpState(jumped.s0, jumped.s1);
+    EXPECT_TRUE(jumped == Apply(jump, s))
+        << std::hex << "From " << s.s0 << ", " << s.s1;
+  }
+}
+
+TEST(RandomTest, SameSeedSameStream) {
+  RandomStream a(1234);
+  RandomStream b(1234);
+  RandomStream c(1235);
+  int same_as_c = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const uint64_t value = a.Next();
+    ASSERT_EQ(value, b.Next()) << "At value " << i;
+    same_as_c += value == c.Next();
+  }
+  EXPECT_EQ(same_as_c, 0);
+
+  std::vector<float> fill_a(999);
+  std::vector<float> fill_b(999);
+  a.Fill(fill_a.data(), fill_a.size(), -1, 1);
+  b.Fill(fill_b.data(), fill_b.size(), -1, 1);
+  EXPECT_EQ(fill_a, fill_b);
+}
+
+TEST(RandomTest, SplitIsReproducible) {
+  RandomStream a(99);
+  RandomStream b(99);
+  a.Split();
+  b.Split();
+  RandomStream split_a = a.Split();
+  RandomStream split_b = b.Split();
+  for (int i = 0; i < 100; ++i) ASSERT_EQ(split_a.Next(), split_b.Next());
+  for (int i = 0; i < 100; ++i) ASSERT_EQ(a.Next(), b.Next());
+}
+
+TEST(RandomTest, SplitStreamsDontOverlap) {
+  constexpr int kStreams = 8;
+  constexpr int kValues = 1 << 16;
+  RandomStream parent(7);
+  std::vector<RandomStream> streams;
+  for (int i = 0; i < kStreams; ++i) streams.push_back(parent.Split());
+  streams.push_back(parent);
+
+  // A repeat of any 64bit value among these would almost certainly mean two
+  // streams share part of the sequence.
+  std::unordered_set<uint64_t> seen;
+  for (RandomStream& stream : streams) {
+    for (int i = 0; i < kValues; ++i) {
+      ASSERT_TRUE(seen.insert(stream.Next()).second);
+    }
+  }
+}
+
+TEST(RandomTest, BoundedFillIsInRange) {
+  srnd(5);
+  std::vector<uint32_t> out(10001);
+  for (const uint32_t bound : {1u, 2u, 3u, 1000u, 0x80000001u, 0xffffffffu}) {
+    rnd_fill(out.data(), out.size(), bound);
+    for (const uint32_t value : out) ASSERT_LT(value, bound);
+  }
+}
+
+TEST(RandomTest, BoundedFillIsUnbiased) {
+  // Without rejection, multiplying 32 random bits by 3 * 2^30 maps two values
+  // to every third result and one to the others, so the results modulo 3
+  // would come out in thirds of 1/2, 1/4 and 1/4.
+  constexpr uint32_t kBound = 3u << 30;
+  constexpr int kSamples = 300000;
+  srnd(6);
+  std::vector<uint32_t> out(kSamples);
+  rnd_fill(out.data(), out.size(), kBound);
+  int counts[3] = {0, 0, 0};
+  for (const uint32_t value : out) ++counts[value % 3];
+  for (const int count : counts) {
+    // Over 10 standard deviations from a bias of 1/4 either way.
+    EXPECT_NEAR(count, kSamples / 3, kSamples / 100);
+  }
+
+  // And a small bound, as a chi-squared test at p = 0.001 with 6 degrees of
+  // freedom.
+  constexpr uint32_t kSmallBound = 7;
+  rnd_fill(out.data(), out.size(), kSmallBound);
+  int small_counts[kSmallBound] = {};
+  for (const uint32_t value : out) ++small_counts[value];
+  const double expected = static_cast<double>(kSamples) / kSmallBound;
+  double chi_squared = 0;
+  for (const int count : small_counts) {
+    chi_squared += (count - expected) * (count - expected) / expected;
+  }
+  EXPECT_LT(chi_squared, 22.46);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace land15
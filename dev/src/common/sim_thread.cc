@@ -0,0 +1,30 @@
+#include "common/sim_thread.h"
+
+#include <stdint.h>
+
+#include <chrono>
+
+namespace land15 {
+namespace common {
+
+int64_t BusyClock::Nanos(Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+void BusyClock::Begin(Clock::time_point now) {
+  const int64_t busy = state_.load(std::memory_order_relaxed) >> 1;
+  state_.store(((Nanos(now) - busy) << 1) | 1, std::memory_order_release);
+}
+
+void BusyClock::End(Clock::time_point now) {
+  const int64_t since = state_.load(std::memory_order_relaxed) >> 1;
+  state_.store((Nanos(now) - since) << 1, std::memory_order_release);
+}
+
+int64_t BusyClock::BusyNanos(Clock::time_point now) const {
+  const int64_t state = state_.load(std::memory_order_acquire);
+  return (state & 1) ? Nanos(now) - (state >> 1) : state >> 1;
+}
+
+}  // namespace common
+}  // namespace land15
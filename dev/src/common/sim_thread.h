@@ -0,0 +1,171 @@
+#ifndef LAND15_COMMON_SIM_THREAD_H_
+#define LAND15_COMMON_SIM_THREAD_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "common/pacing.h"
+#include "common/triple_buffer.h"
+
+namespace land15 {
+namespace common {
+
+// Tracks the total time a thread has spent busy, such that other threads can
+// read it at any time. Lock free.
+class BusyClock {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  void Begin(Clock::time_point now);
+  void End(Clock::time_point now);
+
+  // The total busy time up to `now`. Only exact for times after the last call
+  // to Begin() or End().
+  int64_t BusyNanos(Clock::time_point now) const;
+
+  static int64_t Nanos(Clock::duration d);
+  static int64_t Nanos(Clock::time_point t) {
+    return Nanos(t.time_since_epoch());
+  }
+
+ private:
+  // While busy, (now - busy time) << 1 | 1, else the busy time << 1. Either
+  // way, the busy time at any point is a function of this single value.
+  std::atomic<int64_t> state_ = 0;
+};
+
+// Runs a simulation on its own thread at a fixed tick, handing a snapshot of
+// its state to the render thread after every tick through a TripleBuffer. The
+// render thread draws the newest snapshot while the next ticks simulate, so
+// simulation time no longer adds to frame time.
+template <class Snapshot>
+class SimulationThread {
+ public:
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+
+  // `tick` advances the simulation and writes its state into the snapshot it
+  // is given, which holds an older snapshot to be overwritten. The first tick
+  // runs on the calling thread before this returns.
+  SimulationThread(std::chrono::nanoseconds tick_period,
+                   std::function<void(Snapshot&)> tick)
+      : tick_period_(tick_period), tick_(std::move(tick)) {
+    Tick();
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  ~SimulationThread() {
+    stopping_.store(true, std::memory_order_relaxed);
+    thread_.join();
+  }
+
+  // Called by the render thread as it starts drawing a frame. Returns the
+  // newest snapshot, which stays valid until the next call.
+  const Snapshot& BeginFrame() {
+    const BusyClock::Clock::time_point now = BusyClock::Clock::now();
+    render_clock_.Begin(now);
+    if (buffer_.Update()) {
+      ++fresh_frames_;
+    } else {
+      ++repeated_frames_;
+    }
+    frame_start_ = now;
+    return buffer_.front();
+  }
+
+  // Called by the render thread once it's done with the CPU side of the frame,
+  // typically right before Gfx::Flip() waits on vsync.
+  void EndFrame() {
+    const BusyClock::Clock::time_point now = BusyClock::Clock::now();
+    render_clock_.End(now);
+    render_nanos_ += BusyClock::Nanos(now - frame_start_);
+  }
+
+  struct Stats {
+    int64_t ticks = 0;
+    // Frames that drew a new snapshot, and ones that drew the same snapshot
+    // again.
+    int64_t fresh_frames = 0;
+    int64_t repeated_frames = 0;
+    // Time spent ticking, time spent rendering (between BeginFrame() and
+    // EndFrame()), and time spent ticking while rendering.
+    double sim_seconds = 0;
+    double render_seconds = 0;
+    double overlap_seconds = 0;
+
+    // Snapshots superseded before any frame drew them.
+    int64_t dropped() const { return ticks - fresh_frames; }
+    // The fraction of simulation time hidden behind rendering.
+    double overlap() const {
+      return sim_seconds == 0 ? 0 : overlap_seconds / sim_seconds;
+    }
+  };
+  // Only to be called from the render thread.
+  Stats stats() const {
+    Stats stats;
+    stats.ticks = ticks_.load(std::memory_order_relaxed);
+    stats.fresh_frames = fresh_frames_;
+    stats.repeated_frames = repeated_frames_;
+    stats.sim_seconds = sim_nanos_.load(std::memory_order_relaxed) * 1e-9;
+    stats.render_seconds = render_nanos_ * 1e-9;
+    stats.overlap_seconds =
+        overlap_nanos_.load(std::memory_order_relaxed) * 1e-9;
+    return stats;
+  }
+
+ private:
+  void Tick() {
+    const BusyClock::Clock::time_point start = BusyClock::Clock::now();
+    const int64_t render_start = render_clock_.BusyNanos(start);
+    tick_(buffer_.back());
+    buffer_.Publish();
+    const BusyClock::Clock::time_point end = BusyClock::Clock::now();
+
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+    sim_nanos_.fetch_add(BusyClock::Nanos(end - start),
+                         std::memory_order_relaxed);
+    overlap_nanos_.fetch_add(render_clock_.BusyNanos(end) - render_start,
+                             std::memory_order_relaxed);
+  }
+
+  void Run() {
+    BusyClock::Clock::time_point next = BusyClock::Clock::now() + tick_period_;
+    while (!stopping_.load(std::memory_order_relaxed)) {
+      WaitUntil(next, kWaitHybrid);
+      Tick();
+      next += tick_period_;
+      // Rather than racing to catch up after a long stall, drop the ticks.
+      const BusyClock::Clock::time_point now = BusyClock::Clock::now();
+      if (now - next > tick_period_ * 4) next = now;
+    }
+  }
+
+  const std::chrono::nanoseconds tick_period_;
+  const std::function<void(Snapshot&)> tick_;
+  TripleBuffer<Snapshot> buffer_;
+  BusyClock render_clock_;
+
+  // Written by the simulation thread.
+  std::atomic<int64_t> ticks_ = 0;
+  std::atomic<int64_t> sim_nanos_ = 0;
+  std::atomic<int64_t> overlap_nanos_ = 0;
+
+  // Used by the render thread.
+  int64_t fresh_frames_ = 0;
+  int64_t repeated_frames_ = 0;
+  int64_t render_nanos_ = 0;
+  BusyClock::Clock::time_point frame_start_;
+
+  std::atomic<bool> stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace common
+}  // namespace land15
+
+#endif  // LAND15_COMMON_SIM_THREAD_H_
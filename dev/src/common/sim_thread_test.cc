@@ -0,0 +1,67 @@
+#include "common/sim_thread.h"
+
+#include <stdint.h>
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace common {
+namespace {
+
+using Clock = BusyClock::Clock;
+using std::chrono::nanoseconds;
+
+// A time far from the epoch, as steady_clock's usually are.
+Clock::time_point At(int64_t ns) {
+  return Clock::time_point(
+      std::chrono::duration_cast<Clock::duration>(nanoseconds(ns)) +
+      std::chrono::hours(24 * 365));
+}
+
+TEST(BusyClockTest, SumsBusyIntervals) {
+  BusyClock clock;
+  EXPECT_EQ(clock.BusyNanos(At(0)), 0);
+
+  clock.Begin(At(100));
+  EXPECT_EQ(clock.BusyNanos(At(100)), 0);
+  EXPECT_EQ(clock.BusyNanos(At(130)), 30);
+  clock.End(At(250));
+  EXPECT_EQ(clock.BusyNanos(At(250)), 150);
+  // Idle time doesn't count.
+  EXPECT_EQ(clock.BusyNanos(At(900)), 150);
+
+  clock.Begin(At(1000));
+  EXPECT_EQ(clock.BusyNanos(At(1040)), 190);
+  clock.End(At(1100));
+  EXPECT_EQ(clock.BusyNanos(At(5000)), 250);
+
+  // An empty interval adds nothing.
+  clock.Begin(At(6000));
+  clock.End(At(6000));
+  EXPECT_EQ(clock.BusyNanos(At(7000)), 250);
+}
+
+TEST(SimulationThreadTest, FramesSeeEveryTickInOrder) {
+  int64_t ticks = 0;
+  SimulationThread<int64_t> sim(std::chrono::microseconds(100),
+                                [&ticks](int64_t& snapshot) {
+                                  snapshot = ++ticks;
+                                });
+  int64_t last = 0;
+  for (int frame = 0; frame < 200; ++frame) {
+    const int64_t snapshot = sim.BeginFrame();
+    ASSERT_GE(snapshot, last);
+    last = snapshot;
+    sim.EndFrame();
+  }
+  const SimulationThread<int64_t>::Stats stats = sim.stats();
+  EXPECT_EQ(stats.fresh_frames + stats.repeated_frames, 200);
+  EXPECT_GE(stats.ticks, last);
+  EXPECT_GE(stats.dropped(), 0);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace land15
@@ -0,0 +1,86 @@
+#include "common/spatial_hash.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "glm/vec2.hpp"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace common {
+
+SpatialHash::SpatialHash(float cell_size) : inv_cell_size_(1.0f / cell_size) {
+  CHECK_GT(cell_size, 0) << "Cells must have a size.";
+}
+
+SpatialHash::Handle SpatialHash::Insert(glm::vec2 a, glm::vec2 b) {
+  Handle object;
+  if (free_.empty()) {
+    object = objects_.size();
+    objects_.emplace_back();
+  } else {
+    object = free_.back();
+    free_.pop_back();
+  }
+  Object& added = objects_[object];
+  added.a = glm::vec2(std::min(a.x, b.x), std::min(a.y, b.y));
+  added.b = glm::vec2(std::max(a.x, b.x), std::max(a.y, b.y));
+  added.live = true;
+  AddToCells(object);
+  return object;
+}
+
+void SpatialHash::Move(Handle object, glm::vec2 a, glm::vec2 b) {
+  DCHECK(objects_[object].live) << "Object " << object << " was removed.";
+  Object& moved = objects_[object];
+  moved.a = glm::vec2(std::min(a.x, b.x), std::min(a.y, b.y));
+  moved.b = glm::vec2(std::max(a.x, b.x), std::max(a.y, b.y));
+  if ((Cell(moved.a) == moved.cell_a) && (Cell(moved.b) == moved.cell_b)) {
+    return;
+  }
+  RemoveFromCells(object);
+  AddToCells(object);
+}
+
+void SpatialHash::Remove(Handle object) {
+  DCHECK(objects_[object].live) << "Object " << object << " was removed.";
+  RemoveFromCells(object);
+  objects_[object].live = false;
+  free_.push_back(object);
+}
+
+void SpatialHash::Query(glm::vec2 a, glm::vec2 b,
+                        std::vector<Handle>& out) const {
+  ForEach(a, b, [&out](Handle object) { out.push_back(object); });
+}
+
+void SpatialHash::QueryPoint(glm::vec2 p, std::vector<Handle>& out) const {
+  Query(p, p, out);
+}
+
+void SpatialHash::AddToCells(Handle object) {
+  Object& added = objects_[object];
+  added.cell_a = Cell(added.a);
+  added.cell_b = Cell(added.b);
+  for (int y = added.cell_a.y; y <= added.cell_b.y; ++y) {
+    for (int x = added.cell_a.x; x <= added.cell_b.x; ++x) {
+      cells_[Key({x, y})].push_back(object);
+    }
+  }
+}
+
+void SpatialHash::RemoveFromCells(Handle object) {
+  const Object& removed = objects_[object];
+  for (int y = removed.cell_a.y; y <= removed.cell_b.y; ++y) {
+    for (int x = removed.cell_a.x; x <= removed.cell_b.x; ++x) {
+      std::vector<Handle>& cell = cells_[Key({x, y})];
+      auto found = std::find(cell.begin(), cell.end(), object);
+      DCHECK(found != cell.end()) << "Object " << object << " not in cell.";
+      *found = cell.back();
+      cell.pop_back();
+    }
+  }
+}
+
+}  // namespace common
+}  // namespace land15
@@ -0,0 +1,131 @@
+#ifndef LAND15_COMMON_SPATIAL_HASH_H_
+#define LAND15_COMMON_SPATIAL_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace common {
+
+// Finds the objects overlapping a point or a rectangle, for culling and
+// picking. Objects are axis aligned boxes registered in every cell of a
+// uniform grid they overlap, and the cells are hashed so that the plane is
+// unbounded and only occupied cells take memory. Cells work best about the
+// size of a typical object, or somewhat larger.
+//
+// Queries don't modify the hash, so any number of threads may query it at
+// once as long as none changes it.
+class SpatialHash {
+ public:
+  SpatialHash(const SpatialHash&) = delete;
+  SpatialHash& operator=(const SpatialHash&) = delete;
+
+  typedef int Handle;
+
+  explicit SpatialHash(float cell_size);
+
+  // Adds an object covering the box from `a` to `b`, inclusive. Handles of
+  // removed objects are reused.
+  Handle Insert(glm::vec2 a, glm::vec2 b);
+  // Moves an object, which is cheap when it stays within the same cells.
+  void Move(Handle object, glm::vec2 a, glm::vec2 b);
+  void Remove(Handle object);
+
+  // Calls `fn` with the handle of every object overlapping the box from `a`
+  // to `b`, inclusive, once each and in no particular order.
+  template <typename Fn>
+  void ForEach(glm::vec2 a, glm::vec2 b, Fn&& fn) const;
+  template <typename Fn>
+  void ForEachAt(glm::vec2 p, Fn&& fn) const {
+    ForEach(p, p, std::forward<Fn>(fn));
+  }
+
+  // Like ForEach, but appends the handles to `out`.
+  void Query(glm::vec2 a, glm::vec2 b, std::vector<Handle>& out) const;
+  void QueryPoint(glm::vec2 p, std::vector<Handle>& out) const;
+
+  glm::vec2 min(Handle object) const { return objects_[object].a; }
+  glm::vec2 max(Handle object) const { return objects_[object].b; }
+
+  // Objects in the hash.
+  int size() const { return objects_.size() - free_.size(); }
+
+ private:
+  struct Object {
+    glm::vec2 a;
+    glm::vec2 b;
+    // Cells the object is registered in, inclusive.
+    glm::ivec2 cell_a;
+    glm::ivec2 cell_b;
+    bool live = false;
+  };
+
+  glm::ivec2 Cell(glm::vec2 p) const {
+    return {static_cast<int>(std::floor(p.x * inv_cell_size_)),
+            static_cast<int>(std::floor(p.y * inv_cell_size_))};
+  }
+  static uint64_t Key(glm::ivec2 cell) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) |
+           static_cast<uint32_t>(cell.y);
+  }
+
+  void AddToCells(Handle object);
+  void RemoveFromCells(Handle object);
+
+  // Cell keys pack two coordinates, so std::hash (the identity on most
+  // standard libraries) would pile neighboring columns into few buckets.
+  struct KeyHash {
+    size_t operator()(uint64_t key) const {
+      key *= 0x9e3779b97f4a7c15;
+      return key ^ (key >> 32);
+    }
+  };
+
+  const float inv_cell_size_;
+  std::vector<Object> objects_;
+  std::vector<Handle> free_;
+  // Emptied cells are kept, as objects tend to come back to them.
+  std::unordered_map<uint64_t, std::vector<Handle>, KeyHash> cells_;
+};
+
+// An object overlapping the box is found in every cell they share, so it's
+// only reported from the first of those, the one at the larger of the two
+// top left cells.
+template <typename Fn>
+void SpatialHash::ForEach(glm::vec2 a, glm::vec2 b, Fn&& fn) const {
+  const glm::vec2 lo(std::min(a.x, b.x), std::min(a.y, b.y));
+  const glm::vec2 hi(std::max(a.x, b.x), std::max(a.y, b.y));
+  const glm::ivec2 cell_a = Cell(lo);
+  const glm::ivec2 cell_b = Cell(hi);
+  for (int y = cell_a.y; y <= cell_b.y; ++y) {
+    for (int x = cell_a.x; x <= cell_b.x; ++x) {
+      const auto cell = cells_.find(Key({x, y}));
+      if (cell == cells_.end()) continue;
+      for (const Handle handle : cell->second) {
+        const Object& object = objects_[handle];
+        if ((object.a.x > hi.x) || (object.b.x < lo.x) ||
+            (object.a.y > hi.y) || (object.b.y < lo.y)) {
+          continue;
+        }
+        if ((std::max(object.cell_a.x, cell_a.x) != x) ||
+            (std::max(object.cell_a.y, cell_a.y) != y)) {
+          continue;
+        }
+        fn(handle);
+      }
+    }
+  }
+}
+
+}  // namespace common
+}  // namespace land15
+
+#endif  // LAND15_COMMON_SPATIAL_HASH_H_
@@ -0,0 +1,151 @@
+#include "common/spatial_hash.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "glm/vec2.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace common {
+namespace {
+
+using Handle = SpatialHash::Handle;
+using testing::ElementsAre;
+using testing::IsEmpty;
+using testing::UnorderedElementsAre;
+
+std::vector<Handle> Query(const SpatialHash& hash, glm::vec2 a, glm::vec2 b) {
+  std::vector<Handle> found;
+  hash.Query(a, b, found);
+  return found;
+}
+
+std::vector<Handle> QueryPoint(const SpatialHash& hash, glm::vec2 p) {
+  std::vector<Handle> found;
+  hash.QueryPoint(p, found);
+  return found;
+}
+
+TEST(SpatialHashTest, ObjectsSpanningCellsAreFoundOnce) {
+  SpatialHash hash(10);
+  // 5x4 cells, 1 cell, and 2 cells straddling the origin.
+  const Handle big = hash.Insert({5, 5}, {45, 35});
+  const Handle small = hash.Insert({12, 12}, {13, 13});
+  const Handle straddling = hash.Insert({-3, 2}, {3, 4});
+
+  EXPECT_THAT(Query(hash, {-100, -100}, {100, 100}),
+              UnorderedElementsAre(big, small, straddling));
+  // Queries overlapping the objects' cells at every offset.
+  EXPECT_THAT(Query(hash, {30, 20}, {60, 60}), ElementsAre(big));
+  EXPECT_THAT(Query(hash, {0, 0}, {20, 20}),
+              UnorderedElementsAre(big, small, straddling));
+  EXPECT_THAT(Query(hash, {11, 11}, {44, 34}),
+              UnorderedElementsAre(big, small));
+  // Corners given in either order.
+  EXPECT_THAT(Query(hash, {44, 34}, {11, 11}),
+              UnorderedElementsAre(big, small));
+  EXPECT_EQ(hash.size(), 3);
+}
+
+TEST(SpatialHashTest, ForEachMatchesBruteForce) {
+  SpatialHash hash(16);
+  std::vector<glm::vec2> mins;
+  std::vector<glm::vec2> maxs;
+  // A grid of objects of varied sizes, many spanning several cells.
+  for (int i = 0; i < 200; ++i) {
+    const glm::vec2 a((i * 37) % 300 - 150.0f, (i * 53) % 300 - 150.0f);
+    const glm::vec2 b = a + glm::vec2(i % 7 * 9.5f, i % 5 * 13.25f);
+    ASSERT_EQ(hash.Insert(a, b), i);
+    mins.push_back(a);
+    maxs.push_back(b);
+  }
+  for (int q = 0; q < 100; ++q) {
+    const glm::vec2 a((q * 71) % 340 - 170.0f, (q * 29) % 340 - 170.0f);
+    const glm::vec2 b = a + glm::vec2(q % 9 * 11.0f, q % 4 * 20.0f);
+    std::vector<Handle> expected;
+    for (int i = 0; i < mins.size(); ++i) {
+      if ((mins[i].x <= b.x) && (maxs[i].x >= a.x) && (mins[i].y <= b.y) &&
+          (maxs[i].y >= a.y)) {
+        expected.push_back(i);
+      }
+    }
+    std::vector<Handle> found;
+    hash.ForEach(a, b, [&found](Handle object) { found.push_back(object); });
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, expected) << "Query " << q;
+  }
+}
+
+TEST(SpatialHashTest, NegativeCoordinates) {
+  SpatialHash hash(8);
+  const Handle object = hash.Insert({-20, -30}, {-17, -9});
+  EXPECT_THAT(QueryPoint(hash, {-18, -10}), ElementsAre(object));
+  EXPECT_THAT(Query(hash, {-100, -100}, {-19, -29}), ElementsAre(object));
+  EXPECT_THAT(QueryPoint(hash, {-16.5f, -10}), IsEmpty());
+  // Just either side of zero fall in different cells.
+  const Handle at_zero = hash.Insert({-0.5f, -0.5f}, {0.5f, 0.5f});
+  EXPECT_THAT(QueryPoint(hash, {-0.25f, 0.25f}), ElementsAre(at_zero));
+  EXPECT_THAT(QueryPoint(hash, {0.25f, -0.25f}), ElementsAre(at_zero));
+}
+
+TEST(SpatialHashTest, MoveWithinAndAcrossCells) {
+  SpatialHash hash(10);
+  const Handle object = hash.Insert({1, 1}, {2, 2});
+
+  // Within its cell.
+  hash.Move(object, {5, 5}, {8, 8});
+  EXPECT_THAT(QueryPoint(hash, {6, 6}), ElementsAre(object));
+  EXPECT_THAT(QueryPoint(hash, {1.5f, 1.5f}), IsEmpty());
+  EXPECT_EQ(hash.min(object), glm::vec2(5, 5));
+  EXPECT_EQ(hash.max(object), glm::vec2(8, 8));
+
+  // Across cells, growing over several.
+  hash.Move(object, {25, -15}, {48, 4});
+  EXPECT_THAT(Query(hash, {0, 0}, {10, 10}), IsEmpty());
+  EXPECT_THAT(QueryPoint(hash, {30, -10}), ElementsAre(object));
+  EXPECT_THAT(Query(hash, {-100, -100}, {100, 100}), ElementsAre(object));
+
+  // And back down to one.
+  hash.Move(object, {-5, -5}, {-4, -4});
+  EXPECT_THAT(Query(hash, {20, -20}, {50, 10}), IsEmpty());
+  EXPECT_THAT(QueryPoint(hash, {-4.5f, -4.5f}), ElementsAre(object));
+}
+
+TEST(SpatialHashTest, RemoveAndReuseHandles) {
+  SpatialHash hash(10);
+  const Handle a = hash.Insert({0, 0}, {15, 15});
+  const Handle b = hash.Insert({5, 5}, {6, 6});
+  hash.Remove(a);
+  EXPECT_EQ(hash.size(), 1);
+  EXPECT_THAT(Query(hash, {0, 0}, {20, 20}), ElementsAre(b));
+
+  // The removed handle is handed out again, for the new object only.
+  const Handle c = hash.Insert({100, 100}, {101, 101});
+  EXPECT_EQ(c, a);
+  EXPECT_EQ(hash.size(), 2);
+  EXPECT_THAT(QueryPoint(hash, {12, 12}), IsEmpty());
+  EXPECT_THAT(QueryPoint(hash, {100.5f, 100.5f}), ElementsAre(c));
+  EXPECT_THAT(Query(hash, {0, 0}, {200, 200}), UnorderedElementsAre(b, c));
+}
+
+TEST(SpatialHashTest, PointsOnCellBorders) {
+  SpatialHash hash(10);
+  // Objects meeting on the cell border at x = 10, and touching it.
+  const Handle left = hash.Insert({2, 2}, {10, 8});
+  const Handle right = hash.Insert({10, 2}, {18, 8});
+  const Handle below = hash.Insert({0, 10}, {20, 12});
+
+  // Boxes are inclusive, so a point on a shared edge finds both objects.
+  EXPECT_THAT(QueryPoint(hash, {10, 5}), UnorderedElementsAre(left, right));
+  EXPECT_THAT(QueryPoint(hash, {10, 10}), ElementsAre(below));
+  EXPECT_THAT(QueryPoint(hash, {10, 8}), UnorderedElementsAre(left, right));
+  EXPECT_THAT(QueryPoint(hash, {20, 10}), ElementsAre(below));
+  EXPECT_THAT(QueryPoint(hash, {0, 0}), IsEmpty());
+  EXPECT_THAT(QueryPoint(hash, {9.99f, 9}), IsEmpty());
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace land15
@@ -0,0 +1,61 @@
+#ifndef LAND15_COMMON_TRIPLE_BUFFER_H_
+#define LAND15_COMMON_TRIPLE_BUFFER_H_
+
+#include <atomic>
+
+namespace land15 {
+namespace common {
+
+// Hands values from one producer thread to one consumer thread without either
+// ever waiting on the other, the consumer always getting the newest value.
+//
+// The producer writes into a back slot and publishes it by swapping it with a
+// middle slot, while the consumer reads a front slot, which it swaps with the
+// middle slot whenever something new has been published there. Values that
+// are published but superseded before being consumed are dropped.
+template <class T>
+class TripleBuffer {
+ public:
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  TripleBuffer() = default;
+
+  // The slot being written, only to be used by the producer. It holds
+  // whatever value was there last, so reusing its allocations is cheap.
+  T& back() { return slots_[back_]; }
+
+  // Makes the back slot available to the consumer.
+  void Publish() {
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // Makes the newest published value the front one, returning false if
+  // nothing new was published since the last call. Only to be used by the
+  // consumer.
+  bool Update() {
+    if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  // The slot being read, only to be used by the consumer.
+  const T& front() const { return slots_[front_]; }
+
+ private:
+  static constexpr int kIndexMask = 3;
+  // Set in `middle_` when it holds a value the consumer hasn't seen.
+  static constexpr int kFresh = 4;
+
+  T slots_[3];
+  // Kept on separate cache lines since each is written by a different thread.
+  alignas(64) int back_ = 0;
+  alignas(64) std::atomic<int> middle_ = 1;
+  alignas(64) int front_ = 2;
+};
+
+}  // namespace common
+}  // namespace land15
+
+#endif  // LAND15_COMMON_TRIPLE_BUFFER_H_
@@ -0,0 +1,76 @@
+#include "common/triple_buffer.h"
+
+#include <stdint.h>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace common {
+namespace {
+
+// A value large enough to span cache lines, every word of which holds the
+// same sequence number, so a read overlapping a write shows as mismatched
+// words.
+struct Snapshot {
+  static constexpr int kWords = 64;
+  int64_t words[kWords] = {};
+
+  void Set(int64_t sequence) {
+    for (int64_t& word : words) word = sequence;
+  }
+};
+
+TEST(TripleBufferTest, UpdateTakesTheNewestValue) {
+  TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.Update());
+
+  buffer.back() = 1;
+  buffer.Publish();
+  ASSERT_TRUE(buffer.Update());
+  EXPECT_EQ(buffer.front(), 1);
+  EXPECT_FALSE(buffer.Update());
+  EXPECT_EQ(buffer.front(), 1);
+
+  // Values superseded before an Update() are dropped.
+  buffer.back() = 2;
+  buffer.Publish();
+  buffer.back() = 3;
+  buffer.Publish();
+  ASSERT_TRUE(buffer.Update());
+  EXPECT_EQ(buffer.front(), 3);
+  EXPECT_FALSE(buffer.Update());
+}
+
+TEST(TripleBufferTest, ConcurrentValuesNeverTornOrOutOfOrder) {
+  constexpr int64_t kValues = 200000;
+  TripleBuffer<Snapshot> buffer;
+  std::thread producer([&buffer] {
+    for (int64_t sequence = 1; sequence <= kValues; ++sequence) {
+      buffer.back().Set(sequence);
+      buffer.Publish();
+    }
+  });
+
+  int64_t last = 0;
+  int64_t updates = 0;
+  while (last < kValues) {
+    if (!buffer.Update()) continue;
+    ++updates;
+    const Snapshot& front = buffer.front();
+    const int64_t sequence = front.words[0];
+    for (int i = 1; i < Snapshot::kWords; ++i) {
+      ASSERT_EQ(front.words[i], sequence) << "Torn at word " << i;
+    }
+    ASSERT_GT(sequence, last) << "Went backwards.";
+    last = sequence;
+  }
+  producer.join();
+  EXPECT_GT(updates, 0);
+  EXPECT_FALSE(buffer.Update());
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace land15
@@ -0,0 +1,159 @@
+#include "game/compositor.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/common.hpp"
+#include "glm/vec2.hpp"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace game {
+
+using gfx::Gfx;
+using gfx::Image;
+using glm::ivec2;
+
+int Compositor::AddStatic(const Image& image, ivec2 p, Gfx::PutOptions opts,
+                          ivec2 src_a, ivec2 src_b) {
+  Layer layer;
+  layer.image = &image;
+  layer.p = p;
+  layer.opts = opts;
+  layer.src_a = src_a;
+  layer.src_b = src_b;
+  return AddLayer(std::move(layer));
+}
+
+int Compositor::AddStatic(const Image& image, ivec2 p, ivec2 src_a,
+                          ivec2 src_b) {
+  return AddStatic(image, p, Gfx::PutOptions(), src_a, src_b);
+}
+
+int Compositor::AddDynamic(std::function<void()> draw) {
+  CHECK(draw != nullptr) << "Dynamic layers need something to draw.";
+  Layer layer;
+  layer.draw = std::move(draw);
+  return AddLayer(std::move(layer));
+}
+
+int Compositor::AddLayer(Layer layer) {
+  layers_.push_back(std::move(layer));
+  runs_stale_ = true;
+  return layers_.size() - 1;
+}
+
+void Compositor::Invalidate(int layer) {
+  CHECK((layer >= 0) && (layer < layers_.size()))
+      << "Not a layer: " << layer;
+  CHECK(layers_[layer].image != nullptr)
+      << "Layer " << layer << " is dynamic, so is never cached.";
+  if (runs_stale_) return;
+  runs_[layers_[layer].run].stale = true;
+}
+
+void Compositor::LayerBounds(const Layer& layer, ivec2& a, ivec2& b) {
+  ivec2 dims{layer.image->width(), layer.image->height()};
+  if ((layer.src_a.x != -1) && (layer.src_a.y != -1) &&
+      (layer.src_b.x != -1) && (layer.src_b.y != -1)) {
+    dims = glm::abs(layer.src_b - layer.src_a) + 1;
+  }
+  a = layer.p;
+  b = layer.p + dims - 1;
+}
+
+bool Compositor::Flattens(const Layer& layer) {
+  return (layer.image != nullptr) &&
+         ((layer.opts.blend == Gfx::PutOptions::kBlendNone) ||
+          (layer.opts.blend == Gfx::PutOptions::kBlendAlpha));
+}
+
+void Compositor::BuildRuns() {
+  const ivec2 screen_b = Gfx::GetResolution() - 1;
+  runs_.clear();
+  for (int i = 0; i < layers_.size(); ++i) {
+    Layer& layer = layers_[i];
+    const bool is_static = layer.image != nullptr;
+    const bool extends_run = Flattens(layer) && !runs_.empty() &&
+                             Flattens(layers_[runs_.back().last]);
+    if (!extends_run) {
+      runs_.emplace_back();
+      runs_.back().first = i;
+    }
+    Run& run = runs_.back();
+    run.last = i;
+    layer.run = runs_.size() - 1;
+    if (!is_static) continue;
+
+    ivec2 a;
+    ivec2 b;
+    LayerBounds(layer, a, b);
+    a = glm::max(a, ivec2(0, 0));
+    b = glm::min(b, screen_b);
+    if (!extends_run) {
+      run.a = a;
+      run.b = b;
+      run.opaque = layer.opts.blend == Gfx::PutOptions::kBlendNone;
+    } else {
+      run.a = glm::min(run.a, a);
+      run.b = glm::max(run.b, b);
+    }
+  }
+
+  for (Run& run : runs_) {
+    if (run.opaque) {
+      ivec2 a;
+      ivec2 b;
+      LayerBounds(layers_[run.first], a, b);
+      run.opaque = (a.x <= run.a.x) && (a.y <= run.a.y) && (b.x >= run.b.x) &&
+                   (b.y >= run.b.y);
+    }
+    const bool empty = (run.a.x > run.b.x) || (run.a.y > run.b.y);
+    if ((run.first != run.last) && !empty) {
+      run.cache = Image::OfSize(run.b - run.a + 1);
+    }
+  }
+  runs_stale_ = false;
+}
+
+void Compositor::Redraw(Run& run) {
+  ++cache_redraws_;
+  Gfx::Cls(*run.cache, gfx::Color32::kTransparentBlack);
+  for (int i = run.first; i <= run.last; ++i) {
+    const Layer& layer = layers_[i];
+    Gfx::PutEx(*run.cache, *layer.image, layer.p - run.a, layer.opts,
+               layer.src_a, layer.src_b);
+  }
+  run.stale = false;
+}
+
+void Compositor::Draw() {
+  if (runs_stale_) BuildRuns();
+  for (Run& run : runs_) {
+    const Layer& first = layers_[run.first];
+    if (first.image == nullptr) {
+      first.draw();
+      continue;
+    }
+    if (run.cache == nullptr) {
+      // A lone static layer, or one entirely off screen.
+      for (int i = run.first; i <= run.last; ++i) {
+        const Layer& layer = layers_[i];
+        Gfx::PutEx(*layer.image, layer.p, layer.opts, layer.src_a,
+                   layer.src_b);
+      }
+      continue;
+    }
+    if (run.stale) Redraw(run);
+    Gfx::PutEx(*run.cache, run.a,
+               Gfx::PutOptions().SetBlend(run.opaque
+                                              ? Gfx::PutOptions::kBlendNone
+                                              : Gfx::PutOptions::kBlendAlpha));
+  }
+}
+
+}  // namespace game
+}  // namespace land15
@@ -0,0 +1,110 @@
+#ifndef LAND15_GAME_COMPOSITOR_H_
+#define LAND15_GAME_COMPOSITOR_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace game {
+
+// Draws a scene as an ordered stack of layers, bottom first. Static layers are
+// regions of images that rarely change, dynamic layers are drawn by a
+// function every frame.
+//
+// Each run of adjacent static layers is flattened into a render target the
+// size of their combined bounds, so that the run costs one Put per frame. The
+// cache is only redrawn when a layer of the run is invalidated. A static layer
+// on its own is just drawn, as caching it wouldn't save anything.
+//
+// Static layers are composited with their blend mode, and a run whose bottom
+// layer is drawn without blending and covers the whole run is copied rather
+// than blended. The cache is blended over what's beneath it as a whole, which
+// only matches drawing its layers one by one for layers that are copied or
+// alpha blended, so any other static layer is drawn on its own. For the same
+// reason, the alpha of every pixel of a static layer must be 0 or 255, and
+// layers drawn without blending must be opaque unless they're at the bottom of
+// a run covering all of it.
+class Compositor {
+ public:
+  Compositor(const Compositor&) = delete;
+  Compositor& operator=(const Compositor&) = delete;
+
+  Compositor() = default;
+
+  // Adds a static layer on top drawing the `src_a` to `src_b` region of
+  // `image` at `p`, as Gfx::PutEx would. `image` must outlive the compositor.
+  // Returns the index of the layer.
+  int AddStatic(const gfx::Image& image, glm::ivec2 p,
+                gfx::Gfx::PutOptions opts, glm::ivec2 src_a = {-1, -1},
+                glm::ivec2 src_b = {-1, -1});
+  int AddStatic(const gfx::Image& image, glm::ivec2 p,
+                glm::ivec2 src_a = {-1, -1}, glm::ivec2 src_b = {-1, -1});
+
+  // Adds a layer on top that `draw` draws to the screen on every Draw().
+  int AddDynamic(std::function<void()> draw);
+
+  // Redraws the cache holding static layer `layer` on the next Draw(), as
+  // after its image is drawn to.
+  void Invalidate(int layer);
+
+  // Draws every layer to the screen.
+  void Draw();
+
+  int layer_count() const { return layers_.size(); }
+  // Caches drawn so far, for spotting a static layer invalidated every frame.
+  int64_t cache_redraws() const { return cache_redraws_; }
+
+ private:
+  struct Layer {
+    // Null for dynamic layers.
+    const gfx::Image* image = nullptr;
+    glm::ivec2 p{0, 0};
+    gfx::Gfx::PutOptions opts;
+    glm::ivec2 src_a{-1, -1};
+    glm::ivec2 src_b{-1, -1};
+    std::function<void()> draw;
+    // Index of the run of the layer.
+    int run = -1;
+  };
+
+  // Adjacent layers drawn together: either a single dynamic layer, or any
+  // number of static layers.
+  struct Run {
+    int first = 0;
+    int last = 0;
+    // Screen region covered by the run's layers, inclusive.
+    glm::ivec2 a{0, 0};
+    glm::ivec2 b{-1, -1};
+    // The layers flattened, only for static runs of more than one layer.
+    std::unique_ptr<gfx::Image> cache;
+    bool stale = true;
+    // The run is copied to the screen rather than blended.
+    bool opaque = false;
+  };
+
+  // Whether a layer can be flattened into a cache with its neighbors.
+  static bool Flattens(const Layer& layer);
+  // Screen region a static layer draws to, inclusive and unclipped.
+  static void LayerBounds(const Layer& layer, glm::ivec2& a, glm::ivec2& b);
+  int AddLayer(Layer layer);
+  // Regroups the layers into runs after layers are added.
+  void BuildRuns();
+  void Redraw(Run& run);
+
+  std::vector<Layer> layers_;
+  std::vector<Run> runs_;
+  bool runs_stale_ = false;
+  int64_t cache_redraws_ = 0;
+};
+
+}  // namespace game
+}  // namespace land15
+
+#endif  // LAND15_GAME_COMPOSITOR_H_
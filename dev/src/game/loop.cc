@@ -0,0 +1,129 @@
+#include "game/loop.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+#include "common/pacing.h"
+#include "gfx/gfx.h"
+#include "gfx/input.h"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace game {
+
+namespace {
+
+std::chrono::steady_clock::duration Period(double rate) {
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / rate));
+}
+
+}  // namespace
+
+Loop::Loop(const Options& options)
+    : options_(options),
+      tick_period_(Period(options.tick_rate)),
+      frame_period_(Period(options.frame_rate)) {
+  CHECK_GT(options.tick_rate, 0) << "Tick rate must be positive.";
+  CHECK_GT(options.frame_rate, 0) << "Frame rate must be positive.";
+  CHECK_GT(options.max_ticks_per_frame, 0)
+      << "Must allow at least one tick per frame.";
+  CHECK_GT(options.stats_window, 0) << "Stats window must be positive.";
+  frame_ms_.reserve(options.stats_window);
+}
+
+void Loop::Run(const std::function<void(double dt)>& tick,
+               const std::function<void(float alpha)>& render) {
+  const double dt = std::chrono::duration<double>(tick_period_).count();
+  stopping_ = false;
+  // Flip() would otherwise wait for vsync on top of the loop's own pacing.
+  gfx::Gfx::SetVSync(options_.pacing == kPacingVsync);
+
+  Clock::time_point previous = Clock::now();
+  Clock::duration accumulator = tick_period_;
+  Clock::time_point deadline = previous + frame_period_;
+  last_frame_ = previous;
+  while (!stopping_) {
+    gfx::Gfx::SyncInputs();
+
+    const Clock::time_point now = Clock::now();
+    const uint64_t input_now_ns = gfx::Input::NowNs();
+    accumulator += now - previous;
+    previous = now;
+    int ticks = 0;
+    while ((accumulator >= tick_period_) && !stopping_) {
+      if (ticks == options_.max_ticks_per_frame) {
+        const int64_t backlog = accumulator / tick_period_;
+        dropped_ticks_ += backlog;
+        accumulator -= backlog * tick_period_;
+        break;
+      }
+      // The ticks of a frame catch the simulation up to `now`, each ending
+      // the time left in the accumulator after it before then.
+      accumulator -= tick_period_;
+      tick_time_ns_ =
+          input_now_ns -
+          std::chrono::duration_cast<std::chrono::nanoseconds>(accumulator)
+              .count();
+      tick(dt);
+      ++ticks;
+    }
+    ticks_ += ticks;
+
+    render(std::chrono::duration<float>(accumulator) /
+           std::chrono::duration<float>(tick_period_));
+
+    if (options_.pacing != kPacingVsync) {
+      common::WaitUntil(deadline, options_.pacing == kPacingBusyWait
+                                      ? common::kWaitSpin
+                                      : common::kWaitHybrid);
+      deadline += frame_period_;
+      // Don't try to make up frames after a stall.
+      const Clock::time_point waited = Clock::now();
+      if (deadline < waited) deadline = waited + frame_period_;
+    }
+    gfx::Gfx::Flip();
+    EndFrame(Clock::now());
+  }
+}
+
+void Loop::EndFrame(Clock::time_point now) {
+  const double ms =
+      std::chrono::duration<double, std::milli>(now - last_frame_).count();
+  last_frame_ = now;
+  if (frame_ms_.size() < options_.stats_window) {
+    frame_ms_.push_back(ms);
+  } else {
+    frame_ms_[frames_ % options_.stats_window] = ms;
+  }
+  ++frames_;
+}
+
+Loop::Stats Loop::stats() const {
+  Stats stats;
+  stats.frames = frames_;
+  stats.ticks = ticks_;
+  stats.dropped_ticks = dropped_ticks_;
+  if (frame_ms_.empty()) return stats;
+
+  const auto [min, max] =
+      std::minmax_element(frame_ms_.begin(), frame_ms_.end());
+  stats.frame_ms_min = *min;
+  stats.frame_ms_max = *max;
+  double sum = 0;
+  for (const double ms : frame_ms_) sum += ms;
+  stats.frame_ms_avg = sum / frame_ms_.size();
+  double variance = 0;
+  for (const double ms : frame_ms_) {
+    variance += (ms - stats.frame_ms_avg) * (ms - stats.frame_ms_avg);
+  }
+  stats.jitter_ms = sqrt(variance / frame_ms_.size());
+  return stats;
+}
+
+}  // namespace game
+}  // namespace land15
@@ -0,0 +1,99 @@
+#ifndef LAND15_GAME_LOOP_H_
+#define LAND15_GAME_LOOP_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "common/pacing.h"
+
+namespace land15 {
+namespace game {
+
+// Drives a game: a fixed timestep simulation, ticked as many times per frame
+// as the elapsed time calls for, and a render after each frame's ticks given
+// how far between the last tick and the next it falls, for interpolation.
+// Every frame begins with Gfx::SyncInputs() and ends with Gfx::Flip().
+class Loop {
+ public:
+  Loop(const Loop&) = delete;
+  Loop& operator=(const Loop&) = delete;
+
+  enum Pacing {
+    // Rely on Gfx::Flip() waiting on vsync. The other modes turn vsync off.
+    kPacingVsync = 0,
+    // Spin until each frame's deadline.
+    kPacingBusyWait = 1,
+    // Sleep until close to each frame's deadline, then spin.
+    kPacingHybrid = 2
+  };
+
+  struct Options {
+    // Simulation ticks per second.
+    double tick_rate = 60;
+    // Frames per second, when not paced by vsync.
+    double frame_rate = 60;
+    Pacing pacing = kPacingVsync;
+    // After a stall, at most this many ticks run in a frame, and the rest of
+    // the backlog is dropped rather than spiraling.
+    int max_ticks_per_frame = 5;
+    // Frames the statistics are computed over.
+    int stats_window = 120;
+  };
+
+  explicit Loop(const Options& options);
+
+  // `tick` advances the simulation by `dt` seconds, always the same. `render`
+  // draws it, `alpha` in [0, 1) being how far the frame falls between the
+  // last tick and the next. Returns once Stop() is called.
+  void Run(const std::function<void(double dt)>& tick,
+           const std::function<void(float alpha)>& render);
+
+  // Ends Run() after the current frame.
+  void Stop() { stopping_ = true; }
+
+  // During a tick, the time it simulates up to on the clock of input events
+  // (gfx::Input::NowNs()). Ticks can take the input events stamped up to then
+  // with gfx::Input::Next(), rather than all of a frame's at once.
+  uint64_t tick_time_ns() const { return tick_time_ns_; }
+
+  struct Stats {
+    int64_t frames = 0;
+    int64_t ticks = 0;
+    // Ticks skipped to recover from stalls.
+    int64_t dropped_ticks = 0;
+
+    // Over the last frames of the window: the time from one frame to the next
+    // in milliseconds, and its standard deviation (the jitter).
+    double frame_ms_min = 0;
+    double frame_ms_avg = 0;
+    double frame_ms_max = 0;
+    double jitter_ms = 0;
+  };
+  Stats stats() const;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  void EndFrame(Clock::time_point now);
+
+  const Options options_;
+  const Clock::duration tick_period_;
+  const Clock::duration frame_period_;
+  bool stopping_ = false;
+  uint64_t tick_time_ns_ = 0;
+
+  int64_t frames_ = 0;
+  int64_t ticks_ = 0;
+  int64_t dropped_ticks_ = 0;
+  // A ring of the last frame times, in milliseconds.
+  std::vector<double> frame_ms_;
+  Clock::time_point last_frame_;
+};
+
+}  // namespace game
+}  // namespace land15
+
+#endif  // LAND15_GAME_LOOP_H_
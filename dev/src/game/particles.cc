@@ -0,0 +1,134 @@
+#include "game/particles.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "common/jobs.h"
+#include "common/random.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+#include "glog/logging.h"
+
+// SSE2 is part of x64, so Step() needs no runtime dispatch.
+#if defined(_M_X64) || defined(__x86_64__)
+#define LAND15_PARTICLES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace land15 {
+namespace game {
+
+namespace {
+
+#if defined(LAND15_PARTICLES_SSE2)
+// Per lane `mask ? a : b`.
+inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
+
+// Steps the `n` particles at `xs` and `ys`, drawing 3 * `n` random numbers
+// from `rng` into `noise`.
+void StepRange(const ParticleEmitter::Params& params, float* xs, float* ys,
+               float* noise, int n, common::RandomStream& rng) {
+  rng.Fill(noise, n * 3, 0, 1);
+
+  const glm::vec2 base = params.vel - params.jitter;
+  const float jitter_span = params.jitter * 2;
+  const glm::vec2 lo = params.bounds_min;
+  const glm::vec2 hi = params.bounds_max;
+  const float respawn_span = hi.x - lo.x;
+  const float respawn_y = params.respawn_y;
+  const float* const rx = noise;
+  const float* const ry = noise + n;
+  // The respawn position has its own numbers, as the x jitter of a particle
+  // leaving through a side is skewed towards that side.
+  const float* const rs = noise + n * 2;
+
+  int i = 0;
+#if defined(LAND15_PARTICLES_SSE2)
+  // Branch free, with the respawn as a select, 4 particles at a time.
+  const __m128 base_x = _mm_set1_ps(base.x);
+  const __m128 base_y = _mm_set1_ps(base.y);
+  const __m128 jitter_span_4 = _mm_set1_ps(jitter_span);
+  const __m128 lo_x = _mm_set1_ps(lo.x);
+  const __m128 lo_y = _mm_set1_ps(lo.y);
+  const __m128 hi_x = _mm_set1_ps(hi.x);
+  const __m128 hi_y = _mm_set1_ps(hi.y);
+  const __m128 respawn_span_4 = _mm_set1_ps(respawn_span);
+  const __m128 respawn_y_4 = _mm_set1_ps(respawn_y);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 jx = _mm_loadu_ps(rx + i);
+    const __m128 jy = _mm_loadu_ps(ry + i);
+    const __m128 x = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(xs + i), base_x),
+                                _mm_mul_ps(jitter_span_4, jx));
+    const __m128 y = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(ys + i), base_y),
+                                _mm_mul_ps(jitter_span_4, jy));
+    const __m128 out =
+        _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, lo_x), _mm_cmpgt_ps(x, hi_x)),
+                  _mm_or_ps(_mm_cmplt_ps(y, lo_y), _mm_cmpgt_ps(y, hi_y)));
+    const __m128 respawn_x =
+        _mm_add_ps(lo_x, _mm_mul_ps(respawn_span_4, _mm_loadu_ps(rs + i)));
+    _mm_storeu_ps(xs + i, Select(out, respawn_x, x));
+    _mm_storeu_ps(ys + i, Select(out, respawn_y_4, y));
+  }
+#endif
+  for (; i < n; ++i) {
+    const float x = xs[i] + base.x + jitter_span * rx[i];
+    const float y = ys[i] + base.y + jitter_span * ry[i];
+    if ((x < lo.x) || (x > hi.x) || (y < lo.y) || (y > hi.y)) {
+      xs[i] = lo.x + respawn_span * rs[i];
+      ys[i] = respawn_y;
+    } else {
+      xs[i] = x;
+      ys[i] = y;
+    }
+  }
+}
+
+}  // namespace
+
+ParticleEmitter::ParticleEmitter(int count, const Params& params,
+                                 uint64_t seed)
+    : params_(params), xs_(count), ys_(count), noise_(count * 3) {
+  CHECK_GE(count, 0) << "Particle count can't be negative.";
+  common::RandomStream rng(seed);
+  for (int i = 0; i < count; i += kChunk_) rngs_.push_back(rng.Split());
+
+  rng.Fill(noise_.data(), noise_.size(), 0, 1);
+  const glm::vec2 span = params_.bounds_max - params_.bounds_min;
+  for (int i = 0; i < count; ++i) {
+    xs_[i] = params_.bounds_min.x + noise_[i] * span.x;
+    ys_[i] = params_.bounds_min.y + noise_[count + i] * span.y;
+  }
+}
+
+void ParticleEmitter::Step() { StepChunks(0, chunk_count()); }
+
+void ParticleEmitter::Step(common::JobSystem& jobs) {
+  jobs.ParallelFor(0, chunk_count(), kChunksPerJob_,
+                   [this](int64_t first, int64_t last) {
+                     StepChunks(first, last);
+                   });
+}
+
+void ParticleEmitter::StepChunks(int first, int last) {
+  for (int chunk = first; chunk < last; ++chunk) {
+    const int begin = chunk * kChunk_;
+    const int n = std::min(count() - begin, kChunk_);
+    StepRange(params_, xs_.data() + begin, ys_.data() + begin,
+              noise_.data() + begin * 3, n, rngs_[chunk]);
+  }
+}
+
+void ParticleEmitter::Draw(const gfx::Image& sprite, glm::ivec2 src_a,
+                           glm::ivec2 src_b) const {
+  gfx::Gfx::PutBatch(sprite, xs_.data(), ys_.data(), count(),
+                     gfx::Gfx::PutOptions(), src_a, src_b);
+}
+
+}  // namespace game
+}  // namespace land15
@@ -0,0 +1,81 @@
+#ifndef LAND15_GAME_PARTICLES_H_
+#define LAND15_GAME_PARTICLES_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "common/jobs.h"
+#include "common/random.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace game {
+
+// A set of particles drifting at a common velocity, each also moved by a
+// random jitter every step, that respawn along a horizontal line once they
+// leave their bounds.
+//
+// Positions are stored as separate arrays of x and y coordinates so that
+// Step() vectorizes, and Draw() submits every particle as a single batch.
+// Particles are stepped in chunks, each with its own random stream, so that
+// stepping them in parallel gives the same result as stepping them serially.
+class ParticleEmitter {
+ public:
+  ParticleEmitter(const ParticleEmitter&) = delete;
+  ParticleEmitter& operator=(const ParticleEmitter&) = delete;
+
+  struct Params {
+    // Displacement of every particle per step, in pixels.
+    glm::vec2 vel{0, 0};
+    // Particles are also moved by up to this much along each axis per step.
+    float jitter = 0;
+    // Particles outside of [bounds_min, bounds_max] respawn at a random x in
+    // [bounds_min.x, bounds_max.x) and at `respawn_y`.
+    glm::vec2 bounds_min{0, 0};
+    glm::vec2 bounds_max{0, 0};
+    float respawn_y = 0;
+  };
+
+  // Spawns `count` particles spread uniformly over the bounds. The particles
+  // only depend on `seed`, whichever threads step them.
+  ParticleEmitter(int count, const Params& params, uint64_t seed);
+
+  void Step();
+  // Steps chunks of particles in parallel.
+  void Step(common::JobSystem& jobs);
+
+  // Draws the `src_a` to `src_b` region of `sprite` with its top left corner
+  // at each particle.
+  void Draw(const gfx::Image& sprite, glm::ivec2 src_a,
+            glm::ivec2 src_b) const;
+
+  int count() const { return xs_.size(); }
+  const float* xs() const { return xs_.data(); }
+  const float* ys() const { return ys_.data(); }
+
+ private:
+  // Particles per chunk.
+  static constexpr int kChunk_ = 4096;
+  // Chunks per job when stepping in parallel.
+  static constexpr int kChunksPerJob_ = 4;
+
+  int chunk_count() const { return rngs_.size(); }
+  void StepChunks(int first, int last);
+
+  const Params params_;
+  std::vector<float> xs_;
+  std::vector<float> ys_;
+
+  // Random numbers in [0, 1), three per particle, refilled every step. The
+  // numbers of a chunk are all of its x jitters, then all of its y jitters,
+  // then all of its respawn positions.
+  std::vector<float> noise_;
+  std::vector<common::RandomStream> rngs_;
+};
+
+}  // namespace game
+}  // namespace land15
+
+#endif  // LAND15_GAME_PARTICLES_H_
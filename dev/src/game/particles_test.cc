@@ -0,0 +1,45 @@
+#include "game/particles.h"
+
+#include "common/jobs.h"
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace game {
+namespace {
+
+// Several chunks, the last one partial.
+constexpr int kParticles = 4096 * 5 + 123;
+constexpr int kSteps = 30;
+
+ParticleEmitter::Params SnowParams() {
+  ParticleEmitter::Params params;
+  params.vel = {0.6f, 1.0f};
+  params.jitter = 1.5f;
+  params.bounds_min = {-100, -10};
+  params.bounds_max = {320, 200};
+  params.respawn_y = -10;
+  return params;
+}
+
+class ParticlesTest : public testing::TestWithParam<int> {};
+
+TEST_P(ParticlesTest, ParallelStepMatchesSerial) {
+  common::JobSystem jobs(GetParam());
+  ParticleEmitter serial(kParticles, SnowParams(), 17);
+  ParticleEmitter parallel(kParticles, SnowParams(), 17);
+  for (int step = 0; step < kSteps; ++step) {
+    serial.Step();
+    parallel.Step(jobs);
+  }
+  for (int i = 0; i < kParticles; ++i) {
+    // Bitwise, not approximately.
+    ASSERT_EQ(serial.xs()[i], parallel.xs()[i]) << "Particle " << i;
+    ASSERT_EQ(serial.ys()[i], parallel.ys()[i]) << "Particle " << i;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, ParticlesTest, testing::Values(1, 2, 4));
+
+}  // namespace
+}  // namespace game
+}  // namespace land15
@@ -0,0 +1,62 @@
+#include "game/snowscreen.h"
+
+#include <vector>
+
+#include "common/jobs.h"
+#include "common/random.h"
+#include "game/particles.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace game {
+
+Snowscreen::Snowscreen(int count, glm::vec2 vel, float jitter, int size)
+    : size_(size), flakes_(count, FlakeParams(vel, jitter), common::rnd()) {}
+
+ParticleEmitter::Params Snowscreen::FlakeParams(glm::vec2 vel, float jitter) {
+  auto res = gfx::Gfx::GetResolution();
+  float buffer_x = res.y * -vel.x;
+  const glm::vec2 bounds_x = buffer_x < 0 ? glm::vec2(buffer_x, res.x)
+                                          : glm::vec2(0, res.x + buffer_x);
+  const glm::vec2 bounds_y(-kSnowDim_, res.y + kSnowDim_);
+
+  // The bounds are of flake centers, offset here to the corner of the sprite.
+  const glm::vec2 half_flake = glm::vec2(kSnowDim_, kSnowDim_) * 0.5f;
+  ParticleEmitter::Params params;
+  params.vel = vel;
+  params.jitter = jitter;
+  params.bounds_min = glm::vec2(bounds_x.x, bounds_y.x) - half_flake;
+  params.bounds_max = glm::vec2(bounds_x.y, bounds_y.y) - half_flake;
+  params.respawn_y = -half_flake.y;
+  return params;
+}
+
+void Snowscreen::Step() { flakes_.Step(); }
+
+void Snowscreen::Step(common::JobSystem& jobs) { flakes_.Step(jobs); }
+
+void Snowscreen::Draw(const gfx::Image& flake_texture) const {
+  DrawFlakes(flake_texture, size_, flakes_.xs(), flakes_.ys(), count());
+}
+
+void Snowscreen::Capture(Frame& frame) const {
+  frame.size = size_;
+  frame.xs.assign(flakes_.xs(), flakes_.xs() + count());
+  frame.ys.assign(flakes_.ys(), flakes_.ys() + count());
+}
+
+void Snowscreen::Frame::Draw(const gfx::Image& flake_texture) const {
+  DrawFlakes(flake_texture, size, xs.data(), ys.data(), xs.size());
+}
+
+void Snowscreen::DrawFlakes(const gfx::Image& flake_texture, int size,
+                            const float* xs, const float* ys, int count) {
+  gfx::Gfx::PutBatch(flake_texture, xs, ys, count, gfx::Gfx::PutOptions(),
+                     {(size - 1) * kSnowDim_, 0},
+                     {size * kSnowDim_ - 1, kSnowDim_ - 1});
+}
+
+}  // namespace game
+}  // namespace land15
@@ -0,0 +1,60 @@
+#ifndef LAND15_GAME_SNOWSCREEN_H_
+#define LAND15_GAME_SNOWSCREEN_H_
+
+#include <vector>
+
+#include "common/jobs.h"
+#include "game/particles.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace game {
+
+// A layer of snowflakes drifting across the screen at a given velocity (in
+// pixels per step) with some random jitter. Flakes that leave the bounds
+// respawn at the top. Built on a ParticleEmitter, so drawing is one batch.
+class Snowscreen {
+ public:
+  Snowscreen(const Snowscreen&) = delete;
+  Snowscreen& operator=(const Snowscreen&) = delete;
+
+  // `size` selects the flake sprite, in [1, 3].
+  Snowscreen(int count, glm::vec2 vel, float jitter, int size);
+
+  void Step();
+  // Steps the flakes in parallel.
+  void Step(common::JobSystem& jobs);
+
+  void Draw(const gfx::Image& flake_texture) const;
+
+  int count() const { return flakes_.count(); }
+
+  // What drawing a Snowscreen needs, so that it can be drawn on one thread
+  // while it steps on another.
+  struct Frame {
+    int size = 1;
+    std::vector<float> xs;
+    std::vector<float> ys;
+
+    void Draw(const gfx::Image& flake_texture) const;
+  };
+  // Overwrites `frame`, reusing its storage.
+  void Capture(Frame& frame) const;
+
+ private:
+  static constexpr int kSnowDim_ = 8;
+
+  static ParticleEmitter::Params FlakeParams(glm::vec2 vel, float jitter);
+  static void DrawFlakes(const gfx::Image& flake_texture, int size,
+                         const float* xs, const float* ys, int count);
+
+  const int size_;
+  // Flakes are tracked by the top left corner of their sprite.
+  ParticleEmitter flakes_;
+};
+
+}  // namespace game
+}  // namespace land15
+
+#endif  // LAND15_GAME_SNOWSCREEN_H_
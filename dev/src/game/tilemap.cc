@@ -0,0 +1,269 @@
+#include "game/tilemap.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/common.hpp"
+#include "glm/vec2.hpp"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace game {
+namespace {
+
+// Rounds towards negative infinity, so that negative tiles fall into negative
+// chunks.
+int FloorDiv(int a, int b) { return (a >= 0) ? (a / b) : -((b - 1 - a) / b); }
+
+glm::ivec2 FloorDiv(glm::ivec2 a, glm::ivec2 b) {
+  return {FloorDiv(a.x, b.x), FloorDiv(a.y, b.y)};
+}
+
+}  // namespace
+
+using gfx::Gfx;
+using gfx::Image;
+
+TileMap::TileMap(const Image& tileset, const Options& options, Loader loader)
+    : tileset_(tileset),
+      options_(options),
+      loader_(std::move(loader)),
+      tileset_columns_(tileset.width() / options.tile_size.x),
+      chunk_size_(options.tile_size * options.chunk_tiles) {
+  CHECK_GT(options_.tile_size.x, 0) << "Tiles must have a size.";
+  CHECK_GT(options_.tile_size.y, 0) << "Tiles must have a size.";
+  CHECK_GT(options_.chunk_tiles, 0) << "Chunks must hold tiles.";
+  CHECK_GT(options_.max_textures, 0) << "At least one texture is needed.";
+  CHECK_GT(tileset_columns_, 0) << "Tileset is narrower than a tile.";
+}
+
+uint64_t TileMap::Key(glm::ivec2 chunk) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(chunk.x)) << 32) |
+         static_cast<uint32_t>(chunk.y);
+}
+
+void TileMap::Locate(glm::ivec2 tile, glm::ivec2& chunk, int& index) const {
+  chunk = FloorDiv(tile, glm::ivec2(options_.chunk_tiles));
+  const glm::ivec2 local = tile - chunk * options_.chunk_tiles;
+  index = local.y * options_.chunk_tiles + local.x;
+}
+
+TileMap::Chunk* TileMap::FindChunk(glm::ivec2 chunk) {
+  auto found = chunks_.find(Key(chunk));
+  if (found != chunks_.end()) return &found->second;
+  if (!loader_) return nullptr;
+
+  Chunk& loaded = chunks_[Key(chunk)];
+  loaded.tiles.assign(options_.chunk_tiles * options_.chunk_tiles, kNoTile);
+  loader_(chunk, loaded.tiles.data());
+  loaded.drawn_tiles =
+      loaded.tiles.size() -
+      std::count(loaded.tiles.begin(), loaded.tiles.end(), kNoTile);
+  return &loaded;
+}
+
+TileMap::Chunk& TileMap::GetChunk(glm::ivec2 chunk) {
+  Chunk* found = FindChunk(chunk);
+  if (found != nullptr) return *found;
+
+  Chunk& created = chunks_[Key(chunk)];
+  created.tiles.assign(options_.chunk_tiles * options_.chunk_tiles, kNoTile);
+  return created;
+}
+
+void TileMap::SetTile(Chunk& chunk, int index, uint16_t tile) {
+  uint16_t& current = chunk.tiles[index];
+  if (current == tile) return;
+  chunk.drawn_tiles += (tile != kNoTile) - (current != kNoTile);
+  current = tile;
+  chunk.dirty = true;
+  chunk.changed = true;
+}
+
+uint16_t TileMap::Get(glm::ivec2 tile) {
+  glm::ivec2 chunk;
+  int index;
+  Locate(tile, chunk, index);
+  const Chunk* found = FindChunk(chunk);
+  return (found == nullptr) ? kNoTile : found->tiles[index];
+}
+
+void TileMap::Set(glm::ivec2 tile, uint16_t index) {
+  glm::ivec2 chunk;
+  int tile_index;
+  Locate(tile, chunk, tile_index);
+  SetTile(GetChunk(chunk), tile_index, index);
+}
+
+void TileMap::Fill(glm::ivec2 a, glm::ivec2 b, uint16_t index) {
+  const glm::ivec2 lo = glm::min(a, b);
+  const glm::ivec2 hi = glm::max(a, b);
+  const int n = options_.chunk_tiles;
+  const glm::ivec2 chunk_lo = FloorDiv(lo, glm::ivec2(n));
+  const glm::ivec2 chunk_hi = FloorDiv(hi, glm::ivec2(n));
+
+  // Look up each chunk once, then fill its part of the rectangle.
+  for (int cy = chunk_lo.y; cy <= chunk_hi.y; ++cy) {
+    for (int cx = chunk_lo.x; cx <= chunk_hi.x; ++cx) {
+      const glm::ivec2 origin = glm::ivec2(cx, cy) * n;
+      const glm::ivec2 from = glm::max(lo, origin) - origin;
+      const glm::ivec2 to = glm::min(hi, origin + (n - 1)) - origin;
+      Chunk& chunk = GetChunk({cx, cy});
+      for (int y = from.y; y <= to.y; ++y) {
+        for (int x = from.x; x <= to.x; ++x) SetTile(chunk, y * n + x, index);
+      }
+    }
+  }
+}
+
+void TileMap::Invalidate() {
+  for (auto& [key, chunk] : chunks_) chunk.dirty = true;
+}
+
+void TileMap::Draw(glm::ivec2 camera) { InternalDraw(nullptr, camera); }
+
+void TileMap::Draw(const Image& target, glm::ivec2 camera) {
+  InternalDraw(&target, camera);
+}
+
+void TileMap::InternalDraw(const Image* target, glm::ivec2 camera) {
+  ++draws_;
+  const glm::ivec2 view = (target == nullptr)
+                              ? Gfx::GetResolution()
+                              : glm::ivec2(target->width(), target->height());
+  const glm::ivec2 chunk_lo = FloorDiv(camera, chunk_size_);
+  const glm::ivec2 chunk_hi = FloorDiv(camera + view - 1, chunk_size_);
+
+  for (int cy = chunk_lo.y; cy <= chunk_hi.y; ++cy) {
+    for (int cx = chunk_lo.x; cx <= chunk_hi.x; ++cx) {
+      Chunk* chunk = FindChunk({cx, cy});
+      if (chunk == nullptr) continue;
+      chunk->last_drawn = draws_;
+      if (chunk->dirty) Render(*chunk);
+      if (chunk->texture == nullptr) continue;
+
+      const glm::ivec2 p = glm::ivec2(cx, cy) * chunk_size_ - camera;
+      if (target == nullptr) {
+        Gfx::Put(*chunk->texture, p);
+      } else {
+        Gfx::Put(*target, *chunk->texture, p);
+      }
+    }
+  }
+  Evict();
+}
+
+void TileMap::Render(Chunk& chunk) {
+  if (chunk.drawn_tiles == 0) {
+    ReleaseTexture(chunk);
+    chunk.dirty = false;
+    return;
+  }
+  chunk.dirty = false;
+  if (chunk.texture == nullptr) chunk.texture = AcquireTexture();
+  ++chunk_renders_;
+
+  const Image& texture = *chunk.texture;
+  const Gfx::PutOptions copy =
+      Gfx::PutOptions().SetBlend(Gfx::PutOptions::kBlendNone);
+  const glm::ivec2 tile_size = options_.tile_size;
+  Gfx::Cls(texture, gfx::Color32::kTransparentBlack);
+  for (int y = 0; y < options_.chunk_tiles; ++y) {
+    for (int x = 0; x < options_.chunk_tiles; ++x) {
+      const uint16_t tile = chunk.tiles[y * options_.chunk_tiles + x];
+      if (tile == kNoTile) continue;
+      const glm::ivec2 src_a =
+          glm::ivec2(tile % tileset_columns_, tile / tileset_columns_) *
+          tile_size;
+      DCHECK_LE(src_a.y + tile_size.y, tileset_.height())
+          << "Tile " << tile << " is past the end of the tileset.";
+      Gfx::PutEx(texture, tileset_, glm::ivec2(x, y) * tile_size, copy, src_a,
+                 src_a + tile_size - 1);
+    }
+  }
+}
+
+std::unique_ptr<Image> TileMap::AcquireTexture() {
+  ++textures_;
+  if (!free_textures_.empty()) {
+    std::unique_ptr<Image> texture = std::move(free_textures_.back());
+    free_textures_.pop_back();
+    return texture;
+  }
+  if (textures_ > options_.max_textures) {
+    // Take over the texture of the chunk drawn least recently, unless every
+    // texture is in view, in which case the limit is exceeded until they
+    // aren't.
+    Chunk* oldest = OldestTextured();
+    if (oldest != nullptr) {
+      --textures_;
+      oldest->dirty = true;
+      return std::move(oldest->texture);
+    }
+  }
+  return Image::OfSize(chunk_size_);
+}
+
+void TileMap::ReleaseTexture(Chunk& chunk) {
+  if (chunk.texture == nullptr) return;
+  --textures_;
+  chunk.dirty = true;
+  if (textures_ + static_cast<int>(free_textures_.size()) <
+      options_.max_textures) {
+    free_textures_.push_back(std::move(chunk.texture));
+  } else {
+    chunk.texture.reset();
+  }
+}
+
+TileMap::Chunk* TileMap::OldestTextured() {
+  Chunk* oldest = nullptr;
+  for (auto& [key, chunk] : chunks_) {
+    if ((chunk.texture == nullptr) || (chunk.last_drawn == draws_)) continue;
+    if ((oldest == nullptr) || (chunk.last_drawn < oldest->last_drawn)) {
+      oldest = &chunk;
+    }
+  }
+  return oldest;
+}
+
+void TileMap::Evict() {
+  while (textures_ > options_.max_textures) {
+    Chunk* oldest = OldestTextured();
+    if (oldest == nullptr) break;
+    ReleaseTexture(*oldest);
+  }
+
+  // Drop the unchanged chunks drawn least recently, as the loader can load
+  // them again.
+  if (!loader_) return;
+  const int unchanged =
+      std::count_if(chunks_.begin(), chunks_.end(),
+                    [](const auto& entry) { return !entry.second.changed; });
+  if (unchanged <= options_.max_chunks) return;
+
+  std::vector<std::pair<int64_t, uint64_t>> droppable;
+  for (const auto& [key, chunk] : chunks_) {
+    if (!chunk.changed && (chunk.last_drawn != draws_)) {
+      droppable.emplace_back(chunk.last_drawn, key);
+    }
+  }
+  const int drop =
+      std::min<int>(unchanged - options_.max_chunks, droppable.size());
+  std::partial_sort(droppable.begin(), droppable.begin() + drop,
+                    droppable.end());
+  for (int i = 0; i < drop; ++i) {
+    auto found = chunks_.find(droppable[i].second);
+    ReleaseTexture(found->second);
+    chunks_.erase(found);
+  }
+}
+
+}  // namespace game
+}  // namespace land15
@@ -0,0 +1,129 @@
+#ifndef LAND15_GAME_TILEMAP_H_
+#define LAND15_GAME_TILEMAP_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace game {
+
+// An unbounded grid of tiles drawn from a tileset image, the tiles of which
+// are laid out left to right, top to bottom.
+//
+// Tiles are stored in square chunks, each pre-rendered into its own render
+// target so that drawing the map is one Put per visible chunk rather than one
+// per tile. A chunk is only re-rendered when its tiles change, and only the
+// chunks overlapping the view are drawn.
+//
+// At most `max_textures` chunk textures are kept, those drawn least recently
+// being recycled for newly visible chunks. With a Loader, the map is
+// streamed: chunks are loaded as they come into view, and chunks that haven't
+// been changed since are dropped again beyond `max_chunks`.
+class TileMap {
+ public:
+  TileMap(const TileMap&) = delete;
+  TileMap& operator=(const TileMap&) = delete;
+
+  // Index of a tile that isn't drawn.
+  static constexpr uint16_t kNoTile = 0xffff;
+
+  struct Options {
+    // Dimensions of a tile in pixels.
+    glm::ivec2 tile_size{16, 16};
+    // Width and height of a chunk in tiles.
+    int chunk_tiles = 32;
+    // Chunk textures kept at most.
+    int max_textures = 64;
+    // Loaded chunks kept at most, not counting changed chunks. Only applies
+    // with a Loader.
+    int max_chunks = 1024;
+  };
+
+  // Fills in the tiles of chunk `chunk`, chunk_tiles * chunk_tiles of them in
+  // rows. They start out as kNoTile.
+  typedef std::function<void(glm::ivec2 chunk, uint16_t* tiles)> Loader;
+
+  // `tileset` must outlive the map. Without a `loader`, every tile starts out
+  // as kNoTile.
+  TileMap(const gfx::Image& tileset, const Options& options,
+          Loader loader = nullptr);
+
+  uint16_t Get(glm::ivec2 tile);
+  void Set(glm::ivec2 tile, uint16_t index);
+  // Sets the tiles of the inclusive rectangle from `a` to `b`.
+  void Fill(glm::ivec2 a, glm::ivec2 b, uint16_t index);
+
+  // Re-renders every chunk when next drawn, as after the tileset changes.
+  void Invalidate();
+
+  // Draws the map with `camera` at the top left corner of the screen or
+  // target.
+  void Draw(glm::ivec2 camera);
+  void Draw(const gfx::Image& target, glm::ivec2 camera);
+
+  int resident_chunks() const { return chunks_.size(); }
+  int resident_textures() const { return textures_; }
+  // Chunk renders so far, for spotting a map that's re-rendered every frame.
+  int64_t chunk_renders() const { return chunk_renders_; }
+
+ private:
+  struct Chunk {
+    std::vector<uint16_t> tiles;
+    // Tiles other than kNoTile.
+    int drawn_tiles = 0;
+    // Null when not rendered, or when there's nothing to draw.
+    std::unique_ptr<gfx::Image> texture;
+    // The texture doesn't match the tiles.
+    bool dirty = true;
+    // The tiles differ from what the loader gave, so can't be dropped.
+    bool changed = false;
+    // Draw() call the chunk was last seen in.
+    int64_t last_drawn = -1;
+  };
+
+  static uint64_t Key(glm::ivec2 chunk);
+  // Splits a tile coordinate into its chunk and the tile's index within.
+  void Locate(glm::ivec2 tile, glm::ivec2& chunk, int& index) const;
+  // Returns the chunk, loading it if needed, or null when it isn't loaded and
+  // there's no loader.
+  Chunk* FindChunk(glm::ivec2 chunk);
+  Chunk& GetChunk(glm::ivec2 chunk);
+  void SetTile(Chunk& chunk, int index, uint16_t tile);
+
+  void InternalDraw(const gfx::Image* target, glm::ivec2 camera);
+  void Render(Chunk& chunk);
+  // Gets a texture for a chunk, reusing a free one or one from the chunk drawn
+  // least recently once at the limit.
+  std::unique_ptr<gfx::Image> AcquireTexture();
+  void ReleaseTexture(Chunk& chunk);
+  // The chunk with a texture drawn least recently, other than those drawn by
+  // the current Draw() call.
+  Chunk* OldestTextured();
+  // Frees the textures and chunks drawn least recently beyond the limits.
+  void Evict();
+
+  const gfx::Image& tileset_;
+  const Options options_;
+  const Loader loader_;
+  const int tileset_columns_;
+  const glm::ivec2 chunk_size_;
+
+  std::unordered_map<uint64_t, Chunk> chunks_;
+  // Textures of evicted chunks, ready for reuse.
+  std::vector<std::unique_ptr<gfx::Image>> free_textures_;
+  int textures_ = 0;
+  int64_t draws_ = 0;
+  int64_t chunk_renders_ = 0;
+};
+
+}  // namespace game
+}  // namespace land15
+
+#endif  // LAND15_GAME_TILEMAP_H_
@@ -0,0 +1,187 @@
+#include "gfx/atlas.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gfx/core.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace gfx {
+
+using glm::ivec2;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+// Packs rects into a fixed size area by tracking the top edge ("skyline") of
+// everything placed so far, and placing each rect as low, then as far left, as
+// possible.
+class SkylinePacker {
+ public:
+  SkylinePacker(int w, int h) : w_(w), h_(h), skyline_({{0, 0, w}}) {}
+
+  // Returns false if there's no room for the rect.
+  bool Insert(ivec2 dims, ivec2& p) {
+    int best_i = -1;
+    int best_y = std::numeric_limits<int>::max();
+    for (int i = 0; i < skyline_.size(); ++i) {
+      const int x = skyline_[i].x;
+      if (x + dims.x > w_) break;
+      // The rect rests on the highest segment it spans.
+      int y = 0;
+      for (int j = i; (j < skyline_.size()) && (skyline_[j].x < x + dims.x);
+           ++j) {
+        y = std::max(y, skyline_[j].y);
+      }
+      if ((y + dims.y <= h_) && (y < best_y)) {
+        best_i = i;
+        best_y = y;
+      }
+    }
+    if (best_i == -1) return false;
+    p = {skyline_[best_i].x, best_y};
+
+    // Replace the segments under the rect with its top edge, keeping whatever
+    // is left of the last one it covers.
+    const int right = p.x + dims.x;
+    int end = best_i;
+    while ((end < skyline_.size()) &&
+           (skyline_[end].x + skyline_[end].w <= right)) {
+      ++end;
+    }
+    if (end < skyline_.size()) {
+      skyline_[end].w -= right - skyline_[end].x;
+      skyline_[end].x = right;
+    }
+    skyline_.erase(skyline_.begin() + best_i, skyline_.begin() + end);
+    skyline_.insert(skyline_.begin() + best_i, {p.x, best_y + dims.y, dims.x});
+
+    // Merge neighbors of the same height.
+    for (int i = 0; i + 1 < skyline_.size();) {
+      if (skyline_[i].y == skyline_[i + 1].y) {
+        skyline_[i].w += skyline_[i + 1].w;
+        skyline_.erase(skyline_.begin() + i + 1);
+      } else {
+        ++i;
+      }
+    }
+    used_h_ = std::max(used_h_, best_y + dims.y);
+    return true;
+  }
+
+  int used_height() const { return used_h_; }
+
+ private:
+  struct Segment {
+    int x;
+    int y;
+    int w;
+  };
+
+  const int w_;
+  const int h_;
+  int used_h_ = 0;
+  vector<Segment> skyline_;
+};
+
+// Copies `src` into `dst` at `p`, extending its edges `bleed` pixels outwards.
+void CopyWithBleed(PixelBuffer& src, PixelView dst, ivec2 p, int bleed) {
+  for (int y = -bleed; y < src.h + bleed; ++y) {
+    const Color32* src_row = src.view().row(std::clamp(y, 0, src.h - 1));
+    Color32* dst_row = dst.row(p.y + y) + p.x;
+    for (int x = -bleed; x < 0; ++x) dst_row[x] = src_row[0];
+    std::copy(src_row, src_row + src.w, dst_row);
+    for (int x = src.w; x < src.w + bleed; ++x) {
+      dst_row[x] = src_row[src.w - 1];
+    }
+  }
+}
+
+}  // namespace
+
+unique_ptr<Atlas> Atlas::FromFiles(const vector<std::string>& filenames,
+                                   Options opts) {
+  vector<PixelBuffer> images;
+  images.reserve(filenames.size());
+  for (const std::string& filename : filenames) {
+    images.push_back(Image::DecodeFile(filename));
+  }
+  return FromPixels(std::move(images), opts);
+}
+
+unique_ptr<Atlas> Atlas::FromPixels(vector<PixelBuffer> images,
+                                    Options opts) {
+  CHECK_GE(opts.padding, 0) << "Atlas padding can't be negative.";
+  unique_ptr<Atlas> atlas(new Atlas());
+
+  // Tallest first, then widest, packs best with a skyline.
+  vector<int> order(images.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&images](int l, int r) {
+    return (images[l].h != images[r].h) ? images[l].h > images[r].h
+                                        : images[l].w > images[r].w;
+  });
+
+  const ivec2 pad{opts.padding, opts.padding};
+  vector<SkylinePacker> packers;
+  // Page and position of each image.
+  vector<std::pair<int, ivec2>> placements(images.size());
+  for (const int i : order) {
+    CHECK((images[i].w > 0) && (images[i].h > 0))
+        << "Image " << i << " is empty.";
+    const ivec2 dims = ivec2{images[i].w, images[i].h} + pad * 2;
+    CHECK((dims.x <= opts.page_size) && (dims.y <= opts.page_size))
+        << "Image " << i << " (" << images[i].w << "x" << images[i].h
+        << ") doesn't fit in an atlas page of size " << opts.page_size
+        << " with padding " << opts.padding << ".";
+    ivec2 p;
+    int page = 0;
+    while ((page < packers.size()) && !packers[page].Insert(dims, p)) ++page;
+    if (page == packers.size()) {
+      packers.emplace_back(opts.page_size, opts.page_size);
+      CHECK(packers.back().Insert(dims, p));
+    }
+    placements[i] = {page, p + pad};
+  }
+
+  vector<PixelBuffer> pages(packers.size());
+  for (int page = 0; page < pages.size(); ++page) {
+    pages[page].w = opts.page_size;
+    pages[page].h = packers[page].used_height();
+    pages[page].pixels.assign(pages[page].w * pages[page].h,
+                              Color32::kTransparentBlack);
+  }
+  for (int i = 0; i < images.size(); ++i) {
+    const auto [page, p] = placements[i];
+    CopyWithBleed(images[i], pages[page].view(), p,
+                  opts.bleed ? opts.padding : 0);
+    atlas->stats_.image_pixels += int64_t{images[i].w} * images[i].h;
+  }
+
+  for (PixelBuffer& page : pages) {
+    atlas->stats_.page_pixels += int64_t{page.w} * page.h;
+    atlas->pages_.push_back(Image::FromPixels(std::move(page)));
+  }
+  atlas->stats_.pages = atlas->pages_.size();
+  for (int i = 0; i < images.size(); ++i) {
+    const auto [page, p] = placements[i];
+    atlas->images_.push_back(
+        {atlas->pages_[page].get(), p,
+         p + ivec2{images[i].w, images[i].h} - ivec2{1, 1}});
+  }
+  return atlas;
+}
+
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,85 @@
+#ifndef LAND15_GFX_ATLAS_H_
+#define LAND15_GFX_ATLAS_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gfx/core.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace gfx {
+
+// A set of images packed into as few large textures ("pages") as possible, so
+// that drawing a mix of them doesn't switch textures and batches well. Images
+// are packed with a skyline bottom-left packer, tallest first, and are drawn
+// through SubImage handles.
+class Atlas {
+ public:
+  Atlas(const Atlas&) = delete;
+  Atlas& operator=(const Atlas&) = delete;
+
+  struct Options {
+    // Width and maximum height of a page. Pages are trimmed to the height
+    // used.
+    int page_size = 1024;
+    // Pixels left around each image, so filtering or rounding never samples a
+    // neighbor.
+    int padding = 1;
+    // Fill the padding by extending the edge pixels of each image rather than
+    // leaving it transparent.
+    bool bleed = true;
+  };
+
+  // Packs the images, whose handles are returned by images() in the same
+  // order. Every image must fit in a page along with its padding.
+  static std::unique_ptr<Atlas> FromFiles(
+      const std::vector<std::string>& filenames, Options opts);
+  static std::unique_ptr<Atlas> FromFiles(
+      const std::vector<std::string>& filenames) {
+    return FromFiles(filenames, Options());
+  }
+  static std::unique_ptr<Atlas> FromPixels(std::vector<PixelBuffer> images,
+                                           Options opts);
+  static std::unique_ptr<Atlas> FromPixels(std::vector<PixelBuffer> images) {
+    return FromPixels(std::move(images), Options());
+  }
+
+  const std::vector<SubImage>& images() const { return images_; }
+  const SubImage& image(int i) const { return images_[i]; }
+
+  int page_count() const { return pages_.size(); }
+  const Image& page(int i) const { return *pages_[i]; }
+
+  struct Stats {
+    int pages = 0;
+    // Pixels taken by the images themselves, not counting padding.
+    int64_t image_pixels = 0;
+    // Total pixels of every page.
+    int64_t page_pixels = 0;
+
+    // The fraction of page pixels used by images.
+    double efficiency() const {
+      return page_pixels == 0 ? 0 : static_cast<double>(image_pixels) /
+                                        page_pixels;
+    }
+  };
+  const Stats& stats() const { return stats_; }
+
+ private:
+  Atlas() = default;
+
+  std::vector<std::unique_ptr<Image>> pages_;
+  std::vector<SubImage> images_;
+  Stats stats_;
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_ATLAS_H_
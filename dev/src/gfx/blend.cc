@@ -0,0 +1,150 @@
+#include "gfx/blend.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+#include "glog/logging.h"
+
+#if defined(LAND15_BLEND_X64) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace land15 {
+namespace gfx {
+namespace blend {
+namespace {
+
+template <BlendMode kBlend>
+void ScalarKernel(Color32* dst, const Color32* src, int n, Color32 mod) {
+  if (static_cast<uint32_t>(mod.value) == Color32::kWhite) {
+    for (int i = 0; i < n; ++i) BlendPixel(kBlend, dst[i], src[i]);
+  } else {
+    for (int i = 0; i < n; ++i) {
+      BlendPixel(kBlend, dst[i], Modulate(src[i], mod));
+    }
+  }
+}
+
+Isa DetectIsa() {
+#if !defined(LAND15_BLEND_X64)
+  return kIsaScalar;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  __cpuid(info, 1);
+  // The OS must also save the AVX registers.
+  const bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+                      ((_xgetbv(0) & 0x6) == 0x6);
+  if ((max_leaf >= 7) && os_avx) {
+    __cpuidex(info, 7, 0);
+    if (info[1] & (1 << 5)) return kIsaAvx2;
+  }
+  return kIsaSse2;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? kIsaAvx2 : kIsaSse2;
+#endif
+}
+
+const SpanKernel* KernelsFor(Isa isa) {
+  switch (isa) {
+    case kIsaScalar:
+      return internal::kScalarKernels;
+    case kIsaSse2:
+      return internal::kSse2Kernels;
+    case kIsaAvx2:
+      return internal::kAvx2Kernels;
+    default:
+      CHECK(false) << "Not a real instruction set: " << isa;
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+const SpanKernel kScalarKernels[4] = {
+    ScalarKernel<Gfx::PutOptions::kBlendNone>,
+    ScalarKernel<Gfx::PutOptions::kBlendAlpha>,
+    ScalarKernel<Gfx::PutOptions::kBlendAdd>,
+    ScalarKernel<Gfx::PutOptions::kBlendMod>};
+
+}  // namespace internal
+
+Isa GetSupportedIsa() {
+  static const Isa isa = DetectIsa();
+  return isa;
+}
+
+const char* IsaName(Isa isa) {
+  switch (isa) {
+    case kIsaScalar:
+      return "scalar";
+    case kIsaSse2:
+      return "sse2";
+    case kIsaAvx2:
+      return "avx2";
+    default:
+      CHECK(false) << "Not a real instruction set: " << isa;
+  }
+}
+
+SpanKernel GetSpanKernel(BlendMode blend, Isa isa) {
+  CHECK_LE(isa, GetSupportedIsa())
+      << "Instruction set " << IsaName(isa) << " is not supported.";
+  const SpanKernel* kernels = KernelsFor(isa);
+  CHECK(kernels != nullptr) << "No " << IsaName(isa) << " kernels built.";
+  return kernels[blend];
+}
+
+void BlendSpan(BlendMode blend, Color32* dst, const Color32* src, int n,
+               Color32 mod) {
+  static const SpanKernel* const kernels = KernelsFor(GetSupportedIsa());
+  kernels[blend](dst, src, n, mod);
+}
+
+void BlendPixel(BlendMode blend, Color32& dst, Color32 src) {
+  const uint32_t s = src.value;
+  const uint32_t d = dst.value;
+  const uint32_t sa = s & 0xff;
+  switch (blend) {
+    case Gfx::PutOptions::kBlendNone:
+      dst = src;
+      return;
+    case Gfx::PutOptions::kBlendAlpha: {
+      const uint32_t inv_sa = 255 - sa;
+      dst = (Div255((s >> 24) * sa + (d >> 24) * inv_sa) << 24) |
+            (Div255(((s >> 16) & 0xff) * sa + ((d >> 16) & 0xff) * inv_sa)
+             << 16) |
+            (Div255(((s >> 8) & 0xff) * sa + ((d >> 8) & 0xff) * inv_sa)
+             << 8) |
+            (sa + Div255((d & 0xff) * inv_sa));
+      return;
+    }
+    case Gfx::PutOptions::kBlendAdd:
+      dst = (std::min((d >> 24) + Div255((s >> 24) * sa), 255u) << 24) |
+            (std::min(((d >> 16) & 0xff) + Div255(((s >> 16) & 0xff) * sa),
+                      255u)
+             << 16) |
+            (std::min(((d >> 8) & 0xff) + Div255(((s >> 8) & 0xff) * sa), 255u)
+             << 8) |
+            (d & 0xff);
+      return;
+    case Gfx::PutOptions::kBlendMod:
+      dst = (Div255((s >> 24) * (d >> 24)) << 24) |
+            (Div255(((s >> 16) & 0xff) * ((d >> 16) & 0xff)) << 16) |
+            (Div255(((s >> 8) & 0xff) * ((d >> 8) & 0xff)) << 8) | (d & 0xff);
+      return;
+    default:
+      CHECK(false) << "Not a real blend mode: " << blend;
+  }
+}
+
+}  // namespace blend
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,88 @@
+#ifndef LAND15_GFX_BLEND_H_
+#define LAND15_GFX_BLEND_H_
+
+#include <stdint.h>
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+
+// Span blending kernels for every Gfx::PutOptions::BlendMode, for use by
+// anything compositing Color32 pixels on the CPU. Each mode has a scalar
+// reference implementation along with SSE2 and AVX2 versions that produce
+// bit-identical results; BlendSpan() picks the best one the CPU supports.
+//
+// Source pixels are first multiplied by the mod color, then blended as:
+//
+//   kBlendNone:  dst = src
+//   kBlendAlpha: dst.rgb = src.rgb * src.a + dst.rgb * (1 - src.a)
+//                dst.a = src.a + dst.a * (1 - src.a)
+//   kBlendAdd:   dst.rgb = min(src.rgb * src.a + dst.rgb, 1)
+//   kBlendMod:   dst.rgb = src.rgb * dst.rgb
+//
+// with every product of two channels rounded to the nearest 8bit value.
+
+// The SIMD kernels are only built for x64.
+#if defined(_M_X64) || defined(__x86_64__)
+#define LAND15_BLEND_X64 1
+#endif
+
+namespace land15 {
+namespace gfx {
+namespace blend {
+
+using BlendMode = Gfx::PutOptions::BlendMode;
+
+enum Isa { kIsaScalar = 0, kIsaSse2 = 1, kIsaAvx2 = 2 };
+constexpr int kNumIsas = 3;
+
+// Returns the widest instruction set supported by this CPU.
+Isa GetSupportedIsa();
+
+const char* IsaName(Isa isa);
+
+// Blends `n` pixels from `src` (modulated by `mod`) onto `dst`.
+typedef void (*SpanKernel)(Color32* dst, const Color32* src, int n,
+                           Color32 mod);
+
+// Returns the kernel for the given blend mode and instruction set, which must
+// be supported by this CPU.
+SpanKernel GetSpanKernel(BlendMode blend, Isa isa);
+
+// Blends a span using the best kernel for this CPU.
+void BlendSpan(BlendMode blend, Color32* dst, const Color32* src, int n,
+               Color32 mod = Color32::kWhite);
+
+// Scalar blend of a single (already modulated) source pixel.
+void BlendPixel(BlendMode blend, Color32& dst, Color32 src);
+
+// Rounded division by 255 of a value in [0, 255 * 255].
+inline uint32_t Div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+// Multiplies each channel of `c` by the corresponding channel of `mod`.
+inline Color32 Modulate(Color32 c, Color32 mod) {
+  const uint32_t s = c.value;
+  const uint32_t m = mod.value;
+  return (Div255((s >> 24) * (m >> 24)) << 24) |
+         (Div255(((s >> 16) & 0xff) * ((m >> 16) & 0xff)) << 16) |
+         (Div255(((s >> 8) & 0xff) * ((m >> 8) & 0xff)) << 8) |
+         Div255((s & 0xff) * (m & 0xff));
+}
+
+namespace internal {
+
+// Per-instruction set kernel tables, indexed by BlendMode. The SIMD tables are
+// null when not compiled in.
+extern const SpanKernel kScalarKernels[4];
+extern const SpanKernel* const kSse2Kernels;
+extern const SpanKernel* const kAvx2Kernels;
+
+}  // namespace internal
+
+}  // namespace blend
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_BLEND_H_
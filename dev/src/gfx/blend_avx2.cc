@@ -0,0 +1,102 @@
+#include "gfx/blend.h"
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+
+#if defined(LAND15_BLEND_X64)
+#include <immintrin.h>
+#endif
+
+namespace land15 {
+namespace gfx {
+namespace blend {
+
+#if defined(LAND15_BLEND_X64)
+namespace {
+
+// Pixels are processed 8 at a time, each widened to 16bit channels which are
+// laid out A, B, G, R (lowest lane first). Unpacking and packing both work
+// within 128bit lanes, so pixels come back out in the order they went in.
+
+inline __m256i Div255(__m256i x) {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+inline __m256i Mul255(__m256i a, __m256i b) {
+  return Div255(_mm256_mullo_epi16(a, b));
+}
+
+inline __m256i BroadcastAlpha(__m256i x) {
+  return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0x00), 0x00);
+}
+
+// Blends 4 widened pixels.
+template <BlendMode kBlend>
+inline __m256i Blend(__m256i d, __m256i s) {
+  const __m256i alpha_lane = _mm256_set1_epi64x(0xffff);
+  const __m256i alpha_255 = _mm256_set1_epi64x(0xff);
+  if constexpr (kBlend == Gfx::PutOptions::kBlendNone) {
+    return s;
+  } else if constexpr (kBlend == Gfx::PutOptions::kBlendAlpha) {
+    // dst.a = src.a + dst.a * (1 - src.a) = src.a * 1 + dst.a * (1 - src.a),
+    // so the alpha lane is blended like the others with a factor of 1.
+    const __m256i sa = BroadcastAlpha(s);
+    const __m256i inv_sa = _mm256_sub_epi16(_mm256_set1_epi16(255), sa);
+    const __m256i factor =
+        _mm256_or_si256(_mm256_andnot_si256(alpha_lane, sa), alpha_255);
+    return Div255(_mm256_add_epi16(_mm256_mullo_epi16(s, factor),
+                                   _mm256_mullo_epi16(d, inv_sa)));
+  } else if constexpr (kBlend == Gfx::PutOptions::kBlendAdd) {
+    // Zeroing the factor for the alpha lane leaves dst.a untouched.
+    const __m256i factor = _mm256_andnot_si256(alpha_lane, BroadcastAlpha(s));
+    return _mm256_min_epi16(_mm256_add_epi16(d, Mul255(s, factor)),
+                            _mm256_set1_epi16(255));
+  } else {
+    static_assert(kBlend == Gfx::PutOptions::kBlendMod);
+    // As does multiplying it by 1.
+    return Mul255(_mm256_or_si256(s, alpha_255), d);
+  }
+}
+
+template <BlendMode kBlend>
+void Avx2Kernel(Color32* dst, const Color32* src, int n, Color32 mod) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i mod_wide =
+      _mm256_unpacklo_epi8(_mm256_set1_epi32(mod.value), zero);
+  const bool modulate = static_cast<uint32_t>(mod.value) != Color32::kWhite;
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i s_lo = _mm256_unpacklo_epi8(s, zero);
+    __m256i s_hi = _mm256_unpackhi_epi8(s, zero);
+    if (modulate) {
+      s_lo = Mul255(s_lo, mod_wide);
+      s_hi = Mul255(s_hi, mod_wide);
+    }
+    const __m256i lo = Blend<kBlend>(_mm256_unpacklo_epi8(d, zero), s_lo);
+    const __m256i hi = Blend<kBlend>(_mm256_unpackhi_epi8(d, zero), s_hi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  internal::kScalarKernels[kBlend](dst + i, src + i, n - i, mod);
+}
+
+const SpanKernel kKernels[4] = {Avx2Kernel<Gfx::PutOptions::kBlendNone>,
+                                Avx2Kernel<Gfx::PutOptions::kBlendAlpha>,
+                                Avx2Kernel<Gfx::PutOptions::kBlendAdd>,
+                                Avx2Kernel<Gfx::PutOptions::kBlendMod>};
+
+}  // namespace
+
+const SpanKernel* const internal::kAvx2Kernels = kKernels;
+#else
+const SpanKernel* const internal::kAvx2Kernels = nullptr;
+#endif
+
+}  // namespace blend
+}  // namespace gfx
+}  // namespace land15
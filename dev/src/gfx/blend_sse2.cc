@@ -0,0 +1,100 @@
+#include "gfx/blend.h"
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+
+#if defined(LAND15_BLEND_X64)
+#include <emmintrin.h>
+#endif
+
+namespace land15 {
+namespace gfx {
+namespace blend {
+
+#if defined(LAND15_BLEND_X64)
+namespace {
+
+// Pixels are processed 4 at a time, each widened to 16bit channels which are
+// laid out A, B, G, R (lowest lane first).
+
+inline __m128i Div255(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+inline __m128i Mul255(__m128i a, __m128i b) {
+  return Div255(_mm_mullo_epi16(a, b));
+}
+
+inline __m128i BroadcastAlpha(__m128i x) {
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x00), 0x00);
+}
+
+// Blends 2 widened pixels.
+template <BlendMode kBlend>
+inline __m128i Blend(__m128i d, __m128i s) {
+  const __m128i alpha_lane = _mm_set1_epi64x(0xffff);
+  const __m128i alpha_255 = _mm_set1_epi64x(0xff);
+  if constexpr (kBlend == Gfx::PutOptions::kBlendNone) {
+    return s;
+  } else if constexpr (kBlend == Gfx::PutOptions::kBlendAlpha) {
+    // dst.a = src.a + dst.a * (1 - src.a) = src.a * 1 + dst.a * (1 - src.a),
+    // so the alpha lane is blended like the others with a factor of 1.
+    const __m128i sa = BroadcastAlpha(s);
+    const __m128i inv_sa = _mm_sub_epi16(_mm_set1_epi16(255), sa);
+    const __m128i factor =
+        _mm_or_si128(_mm_andnot_si128(alpha_lane, sa), alpha_255);
+    return Div255(
+        _mm_add_epi16(_mm_mullo_epi16(s, factor), _mm_mullo_epi16(d, inv_sa)));
+  } else if constexpr (kBlend == Gfx::PutOptions::kBlendAdd) {
+    // Zeroing the factor for the alpha lane leaves dst.a untouched.
+    const __m128i factor = _mm_andnot_si128(alpha_lane, BroadcastAlpha(s));
+    return _mm_min_epi16(_mm_add_epi16(d, Mul255(s, factor)),
+                         _mm_set1_epi16(255));
+  } else {
+    static_assert(kBlend == Gfx::PutOptions::kBlendMod);
+    // As does multiplying it by 1.
+    return Mul255(_mm_or_si128(s, alpha_255), d);
+  }
+}
+
+template <BlendMode kBlend>
+void Sse2Kernel(Color32* dst, const Color32* src, int n, Color32 mod) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mod_wide = _mm_unpacklo_epi8(_mm_set1_epi32(mod.value), zero);
+  const bool modulate = static_cast<uint32_t>(mod.value) != Color32::kWhite;
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i d =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i s_lo = _mm_unpacklo_epi8(s, zero);
+    __m128i s_hi = _mm_unpackhi_epi8(s, zero);
+    if (modulate) {
+      s_lo = Mul255(s_lo, mod_wide);
+      s_hi = Mul255(s_hi, mod_wide);
+    }
+    const __m128i lo = Blend<kBlend>(_mm_unpacklo_epi8(d, zero), s_lo);
+    const __m128i hi = Blend<kBlend>(_mm_unpackhi_epi8(d, zero), s_hi);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+  internal::kScalarKernels[kBlend](dst + i, src + i, n - i, mod);
+}
+
+const SpanKernel kKernels[4] = {Sse2Kernel<Gfx::PutOptions::kBlendNone>,
+                                Sse2Kernel<Gfx::PutOptions::kBlendAlpha>,
+                                Sse2Kernel<Gfx::PutOptions::kBlendAdd>,
+                                Sse2Kernel<Gfx::PutOptions::kBlendMod>};
+
+}  // namespace
+
+const SpanKernel* const internal::kSse2Kernels = kKernels;
+#else
+const SpanKernel* const internal::kSse2Kernels = nullptr;
+#endif
+
+}  // namespace blend
+}  // namespace gfx
+}  // namespace land15
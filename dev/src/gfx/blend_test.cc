@@ -0,0 +1,78 @@
+#include "gfx/blend.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "common/random.h"
+#include "gfx/core.h"
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace gfx {
+namespace blend {
+namespace {
+
+// Covers every tail a kernel can leave after its widest loop.
+constexpr int kMaxSpanLength = 66;
+constexpr int kSpansPerLength = 64;
+
+const char* const kBlendNames[] = {"none", "alpha", "add", "mod"};
+
+std::vector<Color32> RandomPixels(common::RandomStream& random, int n) {
+  std::vector<Color32> pixels;
+  pixels.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    pixels.push_back(static_cast<int32_t>(random.Next()));
+  }
+  return pixels;
+}
+
+class BlendParityTest
+    : public testing::TestWithParam<std::tuple<BlendMode, Isa>> {};
+
+TEST_P(BlendParityTest, MatchesScalar) {
+  const auto [blend, isa] = GetParam();
+  if (isa > GetSupportedIsa()) GTEST_SKIP() << IsaName(isa) << " unsupported.";
+
+  const SpanKernel reference = GetSpanKernel(blend, kIsaScalar);
+  const SpanKernel kernel = GetSpanKernel(blend, isa);
+  common::RandomStream random(blend * kNumIsas + isa);
+  for (const bool modulated : {false, true}) {
+    for (int n = 0; n <= kMaxSpanLength; ++n) {
+      for (int span = 0; span < kSpansPerLength; ++span) {
+        const Color32 mod =
+            modulated ? static_cast<int32_t>(random.Next()) : Color32::kWhite;
+        const std::vector<Color32> src = RandomPixels(random, n);
+        std::vector<Color32> expected = RandomPixels(random, n);
+        std::vector<Color32> actual = expected;
+        reference(expected.data(), src.data(), n, mod);
+        kernel(actual.data(), src.data(), n, mod);
+        for (int p = 0; p < n; ++p) {
+          ASSERT_EQ(expected[p].value, actual[p].value)
+              << "Span of " << n << " with mod " << std::hex << mod.value
+              << ", pixel " << std::dec << p;
+        }
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllModes, BlendParityTest,
+    testing::Combine(testing::Values(BlendMode::kBlendNone,
+                                     BlendMode::kBlendAlpha,
+                                     BlendMode::kBlendAdd,
+                                     BlendMode::kBlendMod),
+                     testing::Values(kIsaScalar, kIsaSse2, kIsaAvx2)),
+    [](const testing::TestParamInfo<BlendParityTest::ParamType>& info) {
+      return std::string(kBlendNames[std::get<0>(info.param)]) + "_" +
+             IsaName(std::get<1>(info.param));
+    });
+
+}  // namespace
+}  // namespace blend
+}  // namespace gfx
+}  // namespace land15
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 namespace land15 {
 namespace gfx {
 
@@ -24,7 +26,10 @@ struct Color32 {
     int32_t value;
   };
   
-  Color32& operator=(const int32_t& x) { this->value = x; }
+  Color32& operator=(const int32_t& x) {
+    this->value = x;
+    return *this;
+  }
   operator int32_t() const { return this->value; }
   enum : uint32_t {
     kTransparentBlack = 0x00000000,
@@ -41,6 +46,25 @@ struct Color32 {
 
 static_assert(sizeof(Color32) == 4);
 
+// A view of a 32bit pixel buffer whose rows are `pitch` pixels apart.
+struct PixelView {
+  Color32* pixels;
+  int w;
+  int h;
+  int pitch;
+
+  Color32* row(int y) const { return pixels + y * pitch; }
+};
+
+// A tightly packed 32bit image in system memory.
+struct PixelBuffer {
+  int w = 0;
+  int h = 0;
+  std::vector<Color32> pixels;
+
+  PixelView view() { return {pixels.data(), w, h, w}; }
+};
+
 }  // namespace gfx
 }  // namespace land15
 
@@ -1,12 +1,25 @@
 #include "gfx/gfx.h"
 
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "SDL.h"
 #include "common/deleter_ptr.h"
 #include "gfx/core.h"
 #include "gfx/image.h"
+#include "gfx/input.h"
+#include "gfx/profiler.h"
+#include "gfx/raster.h"
+#include "glm/common.hpp"
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glog/logging.h"
@@ -26,30 +39,173 @@ namespace {
 
 const ivec2 kTextCharacterDims{8, 8};
 
+constexpr int kDefaultProfileWindow = 120;
+
+inline SDL_BlendMode GetSdlBlendMode(Gfx::PutOptions::BlendMode m) {
+  switch (m) {
+    case Gfx::PutOptions::kBlendNone:
+      return SDL_BLENDMODE_NONE;
+    case Gfx::PutOptions::kBlendAlpha:
+      return SDL_BLENDMODE_BLEND;
+    case Gfx::PutOptions::kBlendAdd:
+      return SDL_BLENDMODE_ADD;
+    case Gfx::PutOptions::kBlendMod:
+      return SDL_BLENDMODE_MOD;
+    default:
+      CHECK(false) << "Not a real blend mode: " << m;
+  }
+}
+
+// Makes `src_a` and `src_b`, relative to `src`, relative to its image.
+void ResolveSubImage(const SubImage& src, ivec2& src_a, ivec2& src_b) {
+  if ((src_a.x == -1) || (src_a.y == -1) || (src_b.x == -1) ||
+      (src_b.y == -1)) {
+    src_a = src.a;
+    src_b = src.b;
+    return;
+  }
+  src_a += src.a;
+  src_b += src.a;
+  // Anything outside the SubImage belongs to its neighbors on the page.
+  DCHECK((glm::min(src_a, src_b).x >= src.a.x) &&
+         (glm::min(src_a, src_b).y >= src.a.y) &&
+         (glm::max(src_a, src_b).x <= src.b.x) &&
+         (glm::max(src_a, src_b).y <= src.b.y))
+      << "Region (" << src_a.x - src.a.x << ", " << src_a.y - src.a.y
+      << ") to (" << src_b.x - src.a.x << ", " << src_b.y - src.a.y
+      << ") is outside of the " << src.width() << "x" << src.height()
+      << " SubImage.";
+}
+
+// Appends a textured quad to a vertex batch.
+void AppendQuad(std::vector<SDL_Vertex>& vertices, std::vector<int>& indices,
+                const SDL_FRect& dst_rect, float u0, float v0, float u1,
+                float v1, SDL_Color color) {
+  const int base = vertices.size();
+  const float x0 = dst_rect.x;
+  const float y0 = dst_rect.y;
+  const float x1 = dst_rect.x + dst_rect.w;
+  const float y1 = dst_rect.y + dst_rect.h;
+  vertices.push_back({{x0, y0}, color, {u0, v0}});
+  vertices.push_back({{x1, y0}, color, {u1, v0}});
+  vertices.push_back({{x1, y1}, color, {u1, v1}});
+  vertices.push_back({{x0, y1}, color, {u0, v1}});
+  for (const int i : {0, 1, 2, 2, 3, 0}) indices.push_back(base + i);
+}
+
+// True if the rects overlap or share an edge, so their union covers little
+// more than the two of them.
+bool RectsTouch(const SDL_Rect& a, const SDL_Rect& b) {
+  return (a.x <= b.x + b.w) && (b.x <= a.x + a.w) && (a.y <= b.y + b.h) &&
+         (b.y <= a.y + a.h);
+}
+
+SDL_Rect RectUnion(const SDL_Rect& a, const SDL_Rect& b) {
+  const int x0 = std::min(a.x, b.x);
+  const int y0 = std::min(a.y, b.y);
+  const int x1 = std::max(a.x + a.w, b.x + b.w);
+  const int y1 = std::max(a.y + a.h, b.y + b.h);
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+int RectArea(const SDL_Rect& rect) { return rect.w * rect.h; }
+
+// Appends an untextured quad to a vertex batch.
+void AppendColoredQuad(std::vector<SDL_Vertex>& vertices,
+                       std::vector<int>& indices, const SDL_FRect& dst_rect,
+                       Color32 color) {
+  AppendQuad(vertices, indices, dst_rect, 0, 0, 0, 0,
+             {color.channel.r, color.channel.g, color.channel.b,
+              color.channel.a});
+}
+
+// True if a `dims` sized rect at `x`, `y` misses a target of size `target`.
+bool OffTarget(ivec2 target, float x, float y, ivec2 dims) {
+  return (x >= target.x) || (y >= target.y) || (x + dims.x <= 0) ||
+         (y + dims.y <= 0);
+}
+
 }  // namespace
 
 // Gfx variables
 
 Gfx::Cleanup Gfx::cleanup_;
+bool Gfx::is_init_ = false;
+Gfx::Backend Gfx::backend_ = Gfx::kBackendAccelerated;
+ivec2 Gfx::resolution_{0, 0};
 deleter_ptr<SDL_Window> Gfx::window_ = nullptr;
 deleter_ptr<SDL_Renderer> Gfx::renderer_ = nullptr;
+deleter_ptr<SDL_Texture> Gfx::screen_texture_ = nullptr;
+
+// Deferred drawing, render state shadowing and profiling variables (declared
+// before basic_font_ since destroying an Image touches all of them)
+
+bool Gfx::deferred_ = false;
+std::vector<Gfx::DrawCommand> Gfx::draw_commands_;
+std::vector<SDL_Vertex> Gfx::batch_vertices_;
+std::vector<int> Gfx::batch_indices_;
+std::vector<int> Gfx::quad_indices_;
+std::vector<SDL_FPoint> Gfx::batch_points_;
+std::vector<SDL_FRect> Gfx::batch_rects_;
+Gfx::Glyph Gfx::glyphs_[256];
+std::vector<SDL_Vertex> Gfx::glyph_vertices_;
+std::vector<int> Gfx::glyph_indices_;
+
+std::optional<SDL_Texture*> Gfx::render_target_;
+std::optional<int32_t> Gfx::render_color_;
+
+bool Gfx::dirty_tracking_ = false;
+std::vector<SDL_Rect> Gfx::dirty_rects_;
+float Gfx::updated_fraction_ = 1;
+
+Profiler Gfx::profiler_(kDefaultProfileWindow);
+bool Gfx::profile_overlay_ = false;
+
 unique_ptr<Image> Gfx::basic_font_ = nullptr;
+unique_ptr<Image> Gfx::screen_ = nullptr;
 
 // Input variables
 
 uint32_t Gfx::input_cycle_ = 0;
+Input Gfx::input_;
 
 Gfx::MouseButtonPressedState Gfx::mouse_button_state_{false, false, false};
 ivec3 Gfx::mouse_pointer_position_{0, 0, 0};
 bool Gfx::close_pressed_ = false;
 
 void Gfx::Screen(ivec2 res, bool fullscreen, const string& title,
-                 ivec2 physical_res) {
+                 ivec2 physical_res, Backend backend) {
   CHECK(!is_init()) << "Cannot initialize Gfx more than once.";
 
   sdl::Cleanup::RegisterModule();
-  SDL_Init(SDL_INIT_VIDEO);
+  SDL_Init(backend == kBackendHeadless ? SDL_INIT_EVENTS : SDL_INIT_VIDEO);
+
+  is_init_ = true;
+  backend_ = backend;
+  resolution_ = res;
+
+  // Nothing is known about the state of a fresh renderer.
+  render_target_.reset();
+  render_color_.reset();
+
+  if (is_software()) {
+    screen_ = Image::OfSize(res);
+    Cls();
+  }
+
+  if (backend != kBackendHeadless) {
+    OpenWindow(res, fullscreen, title, physical_res);
+  }
 
+  // Load the system font
+  PrepareFont();
+
+  // Reveal our window
+  if (window_ != nullptr) SDL_ShowWindow(window_.get());
+}
+
+void Gfx::OpenWindow(ivec2 res, bool fullscreen, const string& title,
+                     ivec2 physical_res) {
   if ((physical_res.x == -1) || (physical_res.y == -1)) physical_res = res;
   // We open the window initially hidden (and then reveal it once all of this
   // setup is out of the way)
@@ -63,7 +219,9 @@ void Gfx::Screen(ivec2 res, bool fullscreen, const string& title,
       << "SDL error (SDL_CreateWindowWithPosition): " << SDL_GetError();
   renderer_ = deleter_ptr<SDL_Renderer>(
       SDL_CreateRenderer(window_.get(), NULL,
-                         SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC),
+                         (is_software() ? SDL_RENDERER_SOFTWARE
+                                        : SDL_RENDERER_ACCELERATED) |
+                             SDL_RENDERER_PRESENTVSYNC),
       [](SDL_Renderer* r) { SDL_DestroyRenderer(r); });
 
   CHECK_NE(renderer_.get(), static_cast<SDL_Renderer*>(nullptr))
@@ -77,73 +235,382 @@ void Gfx::Screen(ivec2 res, bool fullscreen, const string& title,
   CHECK_EQ(SDL_SetRenderDrawBlendMode(renderer_.get(), SDL_BLENDMODE_BLEND), 0)
       << "SDL error (SDL_SetRenderDrawBlendMode): " << SDL_GetError();
 
-  // Load the system font
-  PrepareFont();
+  if (is_software()) {
+    screen_texture_ = deleter_ptr<SDL_Texture>(
+        SDL_CreateTexture(renderer_.get(), SDL_PIXELFORMAT_RGBA8888,
+                          SDL_TEXTUREACCESS_STREAMING, res.x, res.y),
+        [](SDL_Texture* t) { SDL_DestroyTexture(t); });
+    CHECK_NE(screen_texture_.get(), static_cast<SDL_Texture*>(nullptr))
+        << "SDL error (SDL_CreateTexture): " << SDL_GetError();
+  }
+}
 
-  // Reveal our window
-  SDL_ShowWindow(window_.get());
+Gfx::Backend Gfx::GetBackend() {
+  CheckInit(__func__);
+  return backend_;
 }
 
 void Gfx::PrepareFont() {
   basic_font_ = Image::FromFile(kSystemFontPath);
-  SDL_Texture* font_tex = basic_font_.get()->texture_.get();
-  CHECK_EQ(SDL_SetTextureBlendMode(font_tex, SDL_BLENDMODE_BLEND), 0)
-      << "SDL error (SDL_SetTextureBlendMode): " << SDL_GetError();
-  CHECK_EQ(SDL_SetTextureAlphaMod(font_tex, 255), 0)
-      << "SDL error (SDL_SetTextureAlphaMod): " << SDL_GetError();
+  for (int i = 0; i < 256; ++i) {
+    const ivec2 origin = internal::GlyphOrigin(i);
+    Glyph& glyph = glyphs_[i];
+    glyph.src_rect = {origin.x, origin.y, kTextCharacterDims.x,
+                      kTextCharacterDims.y};
+    glyph.u0 = glyph.src_rect.x / basic_font_->width();
+    glyph.v0 = glyph.src_rect.y / basic_font_->height();
+    glyph.u1 = (glyph.src_rect.x + glyph.src_rect.w) / basic_font_->width();
+    glyph.v1 = (glyph.src_rect.y + glyph.src_rect.h) / basic_font_->height();
+  }
+  if (is_software()) return;
+  SetTextureBlendMode(*basic_font_, PutOptions::kBlendAlpha);
+  SetTextureMod(*basic_font_, Color32::kWhite);
+}
+
+SDL_Texture* Gfx::TargetTexture(const Image* target) {
+  // With dirty tracking, the accelerated backend draws the screen to screen_.
+  if (target == nullptr) target = screen_.get();
+  return target == nullptr ? nullptr : target->texture_.get();
+}
+
+PixelView Gfx::TargetPixels(const Image* target) {
+  return (target == nullptr ? screen_.get() : target)->pixel_view();
+}
+
+ivec2 Gfx::TargetSize(const Image* target) {
+  return target == nullptr ? resolution_
+                           : ivec2{target->width(), target->height()};
 }
 
 void Gfx::SetRenderTarget(SDL_Texture* target) {
+  if (render_target_ == target) {
+    profiler_.Count(kCounterStateChangesElided);
+    return;
+  }
+  profiler_.Count(kCounterStateChanges);
+  profiler_.Count(kCounterTargetSwitches);
   CHECK_EQ(SDL_SetRenderTarget(renderer_.get(), target), 0)
       << "SDL error (SDL_SetRenderTarget): " << SDL_GetError();
+  render_target_ = target;
 }
 
 void Gfx::SetRenderColor(Color32 col) {
+  if (render_color_ == col.value) {
+    profiler_.Count(kCounterStateChangesElided);
+    return;
+  }
+  profiler_.Count(kCounterStateChanges);
   CHECK_EQ(SDL_SetRenderDrawColor(renderer_.get(), col.channel.r, col.channel.g,
                                   col.channel.b, col.channel.a),
            0)
       << "SDL error (SDL_SetRenderDrawColor): " << SDL_GetError();
+  render_color_ = col.value;
+}
+
+void Gfx::SetTextureBlendMode(const Image& image, PutOptions::BlendMode blend) {
+  const SDL_BlendMode sdl_blend = GetSdlBlendMode(blend);
+  if (image.texture_state_.blend == sdl_blend) {
+    profiler_.Count(kCounterStateChangesElided);
+    return;
+  }
+  profiler_.Count(kCounterStateChanges);
+  CHECK_EQ(SDL_SetTextureBlendMode(image.texture_.get(), sdl_blend), 0)
+      << "SDL error (SDL_SetTextureBlendMode): " << SDL_GetError();
+  image.texture_state_.blend = sdl_blend;
+}
+
+void Gfx::SetTextureMod(const Image& image, Color32 mod) {
+  const int32_t color_mod = mod.value & ~0xff;
+  if (image.texture_state_.color_mod == color_mod) {
+    profiler_.Count(kCounterStateChangesElided);
+  } else {
+    profiler_.Count(kCounterStateChanges);
+    CHECK_EQ(SDL_SetTextureColorMod(image.texture_.get(), mod.channel.r,
+                                    mod.channel.g, mod.channel.b),
+             0)
+        << "SDL error (SDL_SetTextureColorMod): " << SDL_GetError();
+    image.texture_state_.color_mod = color_mod;
+  }
+  const uint8_t alpha_mod = mod.channel.a;
+  if (image.texture_state_.alpha_mod == alpha_mod) {
+    profiler_.Count(kCounterStateChangesElided);
+  } else {
+    profiler_.Count(kCounterStateChanges);
+    CHECK_EQ(SDL_SetTextureAlphaMod(image.texture_.get(), alpha_mod), 0)
+        << "SDL error (SDL_SetTextureAlphaMod): " << SDL_GetError();
+    image.texture_state_.alpha_mod = alpha_mod;
+  }
+}
+
+void Gfx::ForgetImage(const Image& image) {
+  // Deferred draws may still reference the image, and SDL resets the render
+  // target if it's the one being destroyed.
+  FlushDraws();
+  if (render_target_ == image.texture_.get()) render_target_.reset();
 }
 
 bool Gfx::IsFullscreen() {
   CheckInit(__func__);
+  if (window_ == nullptr) return false;
   return SDL_GetWindowFlags(window_.get()) & SDL_WINDOW_FULLSCREEN;
 }
 
 void Gfx::SetFullscreen(bool fullscreen) {
   CheckInit(__func__);
+  CheckWindow(__func__);
   CHECK_EQ(
       SDL_SetWindowFullscreen(window_.get(), fullscreen ? SDL_TRUE : SDL_FALSE),
       0)
       << "SDL error (SDL_SetWindowFullscreen): " << SDL_GetError();
 }
 
+bool Gfx::IsVSync() {
+  CheckInit(__func__);
+  if (window_ == nullptr) return false;
+  int vsync = 0;
+  CHECK_EQ(SDL_GetRenderVSync(renderer_.get(), &vsync), 0)
+      << "SDL error (SDL_GetRenderVSync): " << SDL_GetError();
+  return vsync != 0;
+}
+
+void Gfx::SetVSync(bool vsync) {
+  CheckInit(__func__);
+  if (window_ == nullptr) return;
+  CHECK_EQ(SDL_SetRenderVSync(renderer_.get(), vsync ? 1 : 0), 0)
+      << "SDL error (SDL_SetRenderVSync): " << SDL_GetError();
+}
+
 ivec2 Gfx::GetResolution() {
   CheckInit(__func__);
-  ivec2 res;
-  SDL_RendererLogicalPresentation unused_mode;
-  SDL_ScaleMode unused_scale_mode;
-  SDL_GetRenderLogicalPresentation(renderer_.get(), &res.x, &res.y,
-                                   &unused_mode, &unused_scale_mode);
-  return res;
+  return resolution_;
 }
 
-void Gfx::Flip() { SDL_RenderPresent(renderer_.get()); }
+void Gfx::Flip() {
+  CheckInit(__func__);
+  {
+    const Profiler::ScopedSection section(profiler_, kSectionFlip);
+    if (profile_overlay_) DrawProfileOverlay();
+    FlushDraws();
+    const int64_t screen_area = resolution_.x * resolution_.y;
+    int64_t updated_area = screen_area;
+    if (dirty_tracking_) {
+      updated_area = 0;
+      for (const SDL_Rect& rect : dirty_rects_) updated_area += RectArea(rect);
+    }
+    profiler_.Count(kCounterUpdatedPixels, updated_area);
+    updated_fraction_ = static_cast<float>(updated_area) / screen_area;
+
+    if (is_software() && (window_ != nullptr)) {
+      const int pitch = screen_->width() * sizeof(Color32);
+      if (!dirty_tracking_) {
+        CHECK_EQ(SDL_UpdateTexture(screen_texture_.get(), nullptr,
+                                   screen_->pixels_.data(), pitch),
+                 0)
+            << "SDL error (SDL_UpdateTexture): " << SDL_GetError();
+      }
+      for (const SDL_Rect& rect : dirty_rects_) {
+        CHECK_EQ(SDL_UpdateTexture(
+                     screen_texture_.get(), &rect,
+                     screen_->pixels_.data() + rect.y * screen_->width() +
+                         rect.x,
+                     pitch),
+                 0)
+            << "SDL error (SDL_UpdateTexture): " << SDL_GetError();
+      }
+      CHECK_EQ(SDL_RenderTexture(renderer_.get(), screen_texture_.get(),
+                                 nullptr, nullptr),
+               0)
+          << "SDL error (SDL_RenderTexture): " << SDL_GetError();
+    } else if (dirty_tracking_ && !is_software()) {
+      // The window's back buffer is clobbered by every present, so the kept
+      // screen is copied over whole, which costs the GPU one quad.
+      SetRenderTarget(nullptr);
+      SetTextureBlendMode(*screen_, PutOptions::kBlendNone);
+      SetTextureMod(*screen_, Color32::kWhite);
+      profiler_.CountSubmission(screen_.get());
+      CHECK_EQ(SDL_RenderTexture(renderer_.get(), screen_->texture_.get(),
+                                 nullptr, nullptr),
+               0)
+          << "SDL error (SDL_RenderTexture): " << SDL_GetError();
+    }
+    dirty_rects_.clear();
+    if (renderer_ != nullptr) {
+      const Profiler::ScopedSection present(profiler_, kSectionPresent);
+      SDL_RenderPresent(renderer_.get());
+    }
+  }
+  profiler_.EndFrame();
+}
+
+// Dirty tracking
+
+void Gfx::SetDirtyTracking(bool enabled) {
+  CheckInit(__func__);
+  if (enabled == dirty_tracking_) return;
+  FlushDraws();
+  dirty_tracking_ = enabled;
+  dirty_rects_.clear();
+  updated_fraction_ = 1;
+  if (!is_software()) {
+    if (enabled) {
+      screen_ = Image::OfSize(resolution_);
+      InternalCls(nullptr, Color32::kBlack);
+    } else {
+      screen_.reset();
+    }
+  }
+  // The first tracked Flip() updates the whole screen, as nothing of it may
+  // have been presented yet.
+  if (enabled) MarkDirty(nullptr, {0, 0}, resolution_);
+}
+
+void Gfx::MarkDirty(const Image* target, ivec2 p, ivec2 dims) {
+  if ((target != nullptr) || !dirty_tracking_) return;
+  const int x0 = std::max(p.x, 0);
+  const int y0 = std::max(p.y, 0);
+  const int x1 = std::min(p.x + dims.x, resolution_.x);
+  const int y1 = std::min(p.y + dims.y, resolution_.y);
+  if ((x0 >= x1) || (y0 >= y1)) return;
+  SDL_Rect rect{x0, y0, x1 - x0, y1 - y0};
+
+  // Absorb every rect the new one touches, then once there are too many,
+  // merge it with whichever rect grows the least for it, which may in turn
+  // touch others.
+  while (true) {
+    bool absorbed = false;
+    for (size_t i = 0; i < dirty_rects_.size(); ++i) {
+      if (!RectsTouch(rect, dirty_rects_[i])) continue;
+      rect = RectUnion(rect, dirty_rects_[i]);
+      dirty_rects_[i] = dirty_rects_.back();
+      dirty_rects_.pop_back();
+      absorbed = true;
+      break;
+    }
+    if (absorbed) continue;
+    if (dirty_rects_.size() < kMaxDirtyRects_) break;
+
+    size_t best = 0;
+    int best_growth = std::numeric_limits<int>::max();
+    for (size_t i = 0; i < dirty_rects_.size(); ++i) {
+      const int growth = RectArea(RectUnion(rect, dirty_rects_[i])) -
+                         RectArea(dirty_rects_[i]) - RectArea(rect);
+      if (growth < best_growth) {
+        best = i;
+        best_growth = growth;
+      }
+    }
+    rect = RectUnion(rect, dirty_rects_[best]);
+    dirty_rects_[best] = dirty_rects_.back();
+    dirty_rects_.pop_back();
+  }
+  dirty_rects_.push_back(rect);
+}
+
+// Profiling
+
+void Gfx::SetProfileWindow(int frames) { profiler_.SetWindow(frames); }
+
+void Gfx::SetProfileOverlay(bool enabled) { profile_overlay_ = enabled; }
+
+// Draws with the Internal* calls, so the overlay isn't counted as calls to the
+// public API.
+void Gfx::DrawProfileOverlay() {
+  const Profiler::ScopedSection section(profiler_, kSectionOverlay);
+  const std::vector<string> lines = profiler_.FormatOverlay();
+  int width = 0;
+  for (const string& line : lines) width = std::max<int>(width, line.size());
+  const int height = lines.size();
+  InternalFillRect(nullptr, {0, 0},
+                   {width * kTextCharacterDims.x + 2,
+                    height * kTextCharacterDims.y + 2},
+                   0x000000c0);
+  ivec2 p{1, 1};
+  for (const string& line : lines) {
+    InternalTextLine(nullptr, line, p, Color32::kWhite, kTextAlignHLeft,
+                     kTextAlignVTop);
+    p.y += kTextCharacterDims.y;
+  }
+}
+
+// Deferred drawing
+
+void Gfx::SetDeferred(bool deferred) {
+  CheckInit(__func__);
+  if (!deferred) FlushDraws();
+  deferred_ = deferred && !is_software();
+}
+
+void Gfx::FlushDraws() {
+  if (draw_commands_.empty()) return;
+  const Profiler::ScopedSection section(profiler_, kSectionFlush);
+  const DrawCommand* run_start = draw_commands_.data();
+  const DrawCommand* const end = run_start + draw_commands_.size();
+  for (const DrawCommand* cmd = run_start + 1; cmd != end; ++cmd) {
+    if ((cmd->target != run_start->target) || (cmd->src != run_start->src) ||
+        (cmd->blend != run_start->blend)) {
+      SubmitBatch(run_start, cmd);
+      run_start = cmd;
+    }
+  }
+  SubmitBatch(run_start, end);
+  draw_commands_.clear();
+}
+
+void Gfx::RecordDraw(const DrawCommand& command) {
+  draw_commands_.push_back(command);
+}
+
+// The mod color is carried by the vertex colors, so it doesn't need to match
+// across a batch.
+void Gfx::SubmitBatch(const DrawCommand* begin, const DrawCommand* end) {
+  batch_vertices_.clear();
+  batch_indices_.clear();
+  for (const DrawCommand* cmd = begin; cmd != end; ++cmd) {
+    const SDL_Color color{cmd->mod.channel.r, cmd->mod.channel.g,
+                          cmd->mod.channel.b, cmd->mod.channel.a};
+    const float u0 = cmd->src_rect.x / cmd->src->width();
+    const float v0 = cmd->src_rect.y / cmd->src->height();
+    const float u1 = (cmd->src_rect.x + cmd->src_rect.w) / cmd->src->width();
+    const float v1 = (cmd->src_rect.y + cmd->src_rect.h) / cmd->src->height();
+    AppendQuad(batch_vertices_, batch_indices_, cmd->dst_rect, u0, v0, u1, v1,
+               color);
+  }
+
+  SetRenderTarget(begin->target);
+  SetTextureBlendMode(*begin->src, begin->blend);
+  CHECK_EQ(SDL_RenderGeometry(renderer_.get(), begin->src->texture_.get(),
+                              batch_vertices_.data(), batch_vertices_.size(),
+                              batch_indices_.data(), batch_indices_.size()),
+           0)
+      << "SDL error (SDL_RenderGeometry): " << SDL_GetError();
+  profiler_.CountSubmission(begin->src);
+}
 
 // Cls
 
 void Gfx::Cls(const Image& target, Color32 col) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionCls);
   target.CheckTarget(__func__);
-  InternalCls(target.texture_.get(), col);
+  InternalCls(&target, col);
 }
 void Gfx::Cls(Color32 col) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionCls);
   InternalCls(nullptr, col);
 }
-void Gfx::InternalCls(SDL_Texture* texture, Color32 col) {
-  SetRenderTarget(texture);
+void Gfx::InternalCls(const Image* target, Color32 col) {
+  const ivec2 dims = TargetSize(target);
+  profiler_.Count(kCounterPixels, dims.x * dims.y);
+  MarkDirty(target, {0, 0}, dims);
+  if (is_software()) {
+    raster::Clear(TargetPixels(target), col);
+    return;
+  }
+  FlushDraws();
+  SetRenderTarget(TargetTexture(target));
   SetRenderColor(col);
+  profiler_.CountSubmission(nullptr);
   CHECK_EQ(SDL_RenderClear(renderer_.get()), 0)
       << "SDL error (SDL_RenderClear): " << SDL_GetError();
 }
@@ -152,16 +619,26 @@ void Gfx::InternalCls(SDL_Texture* texture, Color32 col) {
 
 void Gfx::PSet(ivec2 p, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPSet);
   InternalPSet(nullptr, p, color);
 }
 void Gfx::PSet(const Image& target, ivec2 p, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPSet);
   target.CheckTarget(__func__);
-  InternalPSet(target.texture_.get(), p, color);
+  InternalPSet(&target, p, color);
 }
-void Gfx::InternalPSet(SDL_Texture* texture, glm::ivec2 p, Color32 color) {
-  SetRenderTarget(texture);
+void Gfx::InternalPSet(const Image* target, ivec2 p, Color32 color) {
+  profiler_.Count(kCounterPixels);
+  MarkDirty(target, p, {1, 1});
+  if (is_software()) {
+    raster::Point(TargetPixels(target), p, color);
+    return;
+  }
+  FlushDraws();
+  SetRenderTarget(TargetTexture(target));
   SetRenderColor(color);
+  profiler_.CountSubmission(nullptr);
   CHECK_EQ(SDL_RenderPoint(renderer_.get(), p.x, p.y), 0)
       << "SDL error (SDL_RenderPoint): " << SDL_GetError();
 }
@@ -170,16 +647,27 @@ void Gfx::InternalPSet(SDL_Texture* texture, glm::ivec2 p, Color32 color) {
 
 void Gfx::Line(ivec2 a, ivec2 b, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionLine);
   InternalLine(nullptr, a, b, color);
 }
 void Gfx::Line(const Image& target, ivec2 a, ivec2 b, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionLine);
   target.CheckTarget(__func__);
-  InternalLine(target.texture_.get(), a, b, color);
+  InternalLine(&target, a, b, color);
 }
-void Gfx::InternalLine(SDL_Texture* texture, ivec2 a, ivec2 b, Color32 color) {
-  SetRenderTarget(texture);
+void Gfx::InternalLine(const Image* target, ivec2 a, ivec2 b, Color32 color) {
+  profiler_.Count(kCounterPixels,
+                  std::max(std::abs(b.x - a.x), std::abs(b.y - a.y)) + 1);
+  MarkDirty(target, glm::min(a, b), glm::abs(b - a) + 1);
+  if (is_software()) {
+    raster::Line(TargetPixels(target), a, b, color);
+    return;
+  }
+  FlushDraws();
+  SetRenderTarget(TargetTexture(target));
   SetRenderColor(color);
+  profiler_.CountSubmission(nullptr);
   CHECK_EQ(SDL_RenderLine(renderer_.get(), a.x, a.y, b.x, b.y), 0)
       << "SDL error (SDL_RenderLine): " << SDL_GetError();
 }
@@ -188,17 +676,27 @@ void Gfx::InternalLine(SDL_Texture* texture, ivec2 a, ivec2 b, Color32 color) {
 
 void Gfx::Rect(ivec2 a, ivec2 b, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionRect);
   InternalRect(nullptr, a, b, color);
 }
 void Gfx::Rect(const Image& target, ivec2 a, ivec2 b, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionRect);
   target.CheckTarget(__func__);
-  InternalRect(target.texture_.get(), a, b, color);
+  InternalRect(&target, a, b, color);
 }
-void Gfx::InternalRect(SDL_Texture* texture, ivec2 a, ivec2 b, Color32 color) {
-  SetRenderTarget(texture);
+void Gfx::InternalRect(const Image* target, ivec2 a, ivec2 b, Color32 color) {
+  if ((b.x > 0) && (b.y > 0)) profiler_.Count(kCounterPixels, 2 * (b.x + b.y));
+  MarkDirty(target, a, b);
+  if (is_software()) {
+    raster::Rect(TargetPixels(target), a, b, color);
+    return;
+  }
+  FlushDraws();
+  SetRenderTarget(TargetTexture(target));
   SetRenderColor(color);
   SDL_FRect rect{a.x, a.y, b.x, b.y};
+  profiler_.CountSubmission(nullptr);
   CHECK_EQ(SDL_RenderRect(renderer_.get(), &rect), 0)
       << "SDL error (SDL_RenderRect): " << SDL_GetError();
 }
@@ -207,105 +705,518 @@ void Gfx::InternalRect(SDL_Texture* texture, ivec2 a, ivec2 b, Color32 color) {
 
 void Gfx::FillRect(ivec2 a, ivec2 b, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionFillRect);
   InternalFillRect(nullptr, a, b, color);
 }
 void Gfx::FillRect(const Image& target, ivec2 a, ivec2 b, Color32 color) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionFillRect);
   target.CheckTarget(__func__);
-  InternalFillRect(target.texture_.get(), a, b, color);
+  InternalFillRect(&target, a, b, color);
 }
-void Gfx::InternalFillRect(SDL_Texture* texture, ivec2 a, ivec2 b,
+void Gfx::InternalFillRect(const Image* target, ivec2 a, ivec2 b,
                            Color32 color) {
-  SetRenderTarget(texture);
+  if ((b.x > 0) && (b.y > 0)) profiler_.Count(kCounterPixels, b.x * b.y);
+  MarkDirty(target, a, b);
+  if (is_software()) {
+    raster::FillRect(TargetPixels(target), a, b, color);
+    return;
+  }
+  FlushDraws();
+  SetRenderTarget(TargetTexture(target));
   SetRenderColor(color);
   SDL_FRect rect{a.x, a.y, b.x, b.y};
+  profiler_.CountSubmission(nullptr);
   CHECK_EQ(SDL_RenderFillRect(renderer_.get(), &rect), 0)
       << "SDL error (SDL_RenderFillRect): " << SDL_GetError();
 }
 
+// Batch primitives
+
+void Gfx::PSet(std::span<const ivec2> points, Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPSet);
+  InternalPSets(nullptr, points, color, {});
+}
+void Gfx::PSet(std::span<const ivec2> points, std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPSet);
+  CHECK_EQ(colors.size(), points.size()) << "Need a color per point.";
+  InternalPSets(nullptr, points, Color32::kWhite, colors);
+}
+void Gfx::PSet(const Image& target, std::span<const ivec2> points,
+               Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPSet);
+  target.CheckTarget(__func__);
+  InternalPSets(&target, points, color, {});
+}
+void Gfx::PSet(const Image& target, std::span<const ivec2> points,
+               std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPSet);
+  target.CheckTarget(__func__);
+  CHECK_EQ(colors.size(), points.size()) << "Need a color per point.";
+  InternalPSets(&target, points, Color32::kWhite, colors);
+}
+void Gfx::Line(std::span<const Segment> segments, Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionLine);
+  InternalLines(nullptr, segments, color, {});
+}
+void Gfx::Line(std::span<const Segment> segments,
+               std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionLine);
+  CHECK_EQ(colors.size(), segments.size()) << "Need a color per segment.";
+  InternalLines(nullptr, segments, Color32::kWhite, colors);
+}
+void Gfx::Line(const Image& target, std::span<const Segment> segments,
+               Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionLine);
+  target.CheckTarget(__func__);
+  InternalLines(&target, segments, color, {});
+}
+void Gfx::Line(const Image& target, std::span<const Segment> segments,
+               std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionLine);
+  target.CheckTarget(__func__);
+  CHECK_EQ(colors.size(), segments.size()) << "Need a color per segment.";
+  InternalLines(&target, segments, Color32::kWhite, colors);
+}
+void Gfx::Rect(std::span<const Box> boxes, Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionRect);
+  InternalRects(nullptr, boxes, false, color, {});
+}
+void Gfx::Rect(std::span<const Box> boxes, std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionRect);
+  CHECK_EQ(colors.size(), boxes.size()) << "Need a color per box.";
+  InternalRects(nullptr, boxes, false, Color32::kWhite, colors);
+}
+void Gfx::Rect(const Image& target, std::span<const Box> boxes, Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionRect);
+  target.CheckTarget(__func__);
+  InternalRects(&target, boxes, false, color, {});
+}
+void Gfx::Rect(const Image& target, std::span<const Box> boxes,
+               std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionRect);
+  target.CheckTarget(__func__);
+  CHECK_EQ(colors.size(), boxes.size()) << "Need a color per box.";
+  InternalRects(&target, boxes, false, Color32::kWhite, colors);
+}
+void Gfx::FillRect(std::span<const Box> boxes, Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionFillRect);
+  InternalRects(nullptr, boxes, true, color, {});
+}
+void Gfx::FillRect(std::span<const Box> boxes,
+                   std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionFillRect);
+  CHECK_EQ(colors.size(), boxes.size()) << "Need a color per box.";
+  InternalRects(nullptr, boxes, true, Color32::kWhite, colors);
+}
+void Gfx::FillRect(const Image& target, std::span<const Box> boxes,
+                   Color32 color) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionFillRect);
+  target.CheckTarget(__func__);
+  InternalRects(&target, boxes, true, color, {});
+}
+void Gfx::FillRect(const Image& target, std::span<const Box> boxes,
+                   std::span<const Color32> colors) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionFillRect);
+  target.CheckTarget(__func__);
+  CHECK_EQ(colors.size(), boxes.size()) << "Need a color per box.";
+  InternalRects(&target, boxes, true, Color32::kWhite, colors);
+}
+void Gfx::InternalPSets(const Image* target, std::span<const ivec2> points,
+                        Color32 color, std::span<const Color32> colors) {
+  if (points.empty()) return;
+  ivec2 lo(std::numeric_limits<int>::max());
+  ivec2 hi(std::numeric_limits<int>::min());
+  for (const ivec2 p : points) {
+    lo = glm::min(lo, p);
+    hi = glm::max(hi, p);
+  }
+  profiler_.Count(kCounterPixels, points.size());
+  MarkDirty(target, lo, hi - lo + 1);
+  if (is_software()) {
+    const PixelView dst = TargetPixels(target);
+    for (int i = 0; i < points.size(); ++i) {
+      raster::Point(dst, points[i], colors.empty() ? color : colors[i]);
+    }
+    return;
+  }
+  FlushDraws();
+  if (!colors.empty()) {
+    batch_vertices_.clear();
+    batch_indices_.clear();
+    for (int i = 0; i < points.size(); ++i) {
+      AppendColoredQuad(batch_vertices_, batch_indices_,
+                        {points[i].x, points[i].y, 1, 1}, colors[i]);
+    }
+    SubmitColoredQuads(target);
+    return;
+  }
+  batch_points_.clear();
+  for (const ivec2 p : points) batch_points_.push_back({p.x, p.y});
+  SetRenderTarget(TargetTexture(target));
+  SetRenderColor(color);
+  profiler_.CountSubmission(nullptr);
+  CHECK_EQ(SDL_RenderPoints(renderer_.get(), batch_points_.data(),
+                            batch_points_.size()),
+           0)
+      << "SDL error (SDL_RenderPoints): " << SDL_GetError();
+}
+
+void Gfx::InternalLines(const Image* target, std::span<const Segment> segments,
+                        Color32 color, std::span<const Color32> colors) {
+  if (segments.empty()) return;
+  uint64_t pixels = 0;
+  ivec2 lo(std::numeric_limits<int>::max());
+  ivec2 hi(std::numeric_limits<int>::min());
+  for (const Segment& segment : segments) {
+    const ivec2 d = glm::abs(segment.b - segment.a);
+    pixels += std::max(d.x, d.y) + 1;
+    lo = glm::min(lo, glm::min(segment.a, segment.b));
+    hi = glm::max(hi, glm::max(segment.a, segment.b));
+  }
+  profiler_.Count(kCounterPixels, pixels);
+  MarkDirty(target, lo, hi - lo + 1);
+  if (is_software()) {
+    const PixelView dst = TargetPixels(target);
+    for (int i = 0; i < segments.size(); ++i) {
+      raster::Line(dst, segments[i].a, segments[i].b,
+                   colors.empty() ? color : colors[i]);
+    }
+    return;
+  }
+  FlushDraws();
+  if (!colors.empty()) {
+    batch_vertices_.clear();
+    batch_indices_.clear();
+    for (int i = 0; i < segments.size(); ++i) {
+      raster::ForEachLinePoint(segments[i].a, segments[i].b, [&](ivec2 p) {
+        AppendColoredQuad(batch_vertices_, batch_indices_, {p.x, p.y, 1, 1},
+                          colors[i]);
+      });
+    }
+    SubmitColoredQuads(target);
+    return;
+  }
+  batch_points_.clear();
+  for (const Segment& segment : segments) {
+    raster::ForEachLinePoint(segment.a, segment.b, [](ivec2 p) {
+      batch_points_.push_back({p.x, p.y});
+    });
+  }
+  SetRenderTarget(TargetTexture(target));
+  SetRenderColor(color);
+  profiler_.CountSubmission(nullptr);
+  CHECK_EQ(SDL_RenderPoints(renderer_.get(), batch_points_.data(),
+                            batch_points_.size()),
+           0)
+      << "SDL error (SDL_RenderPoints): " << SDL_GetError();
+}
+
+void Gfx::InternalRects(const Image* target, std::span<const Box> boxes,
+                        bool fill, Color32 color,
+                        std::span<const Color32> colors) {
+  if (boxes.empty()) return;
+  uint64_t pixels = 0;
+  ivec2 lo(std::numeric_limits<int>::max());
+  ivec2 hi(std::numeric_limits<int>::min());
+  for (const Box& box : boxes) {
+    if ((box.dims.x <= 0) || (box.dims.y <= 0)) continue;
+    pixels += fill ? box.dims.x * box.dims.y : 2 * (box.dims.x + box.dims.y);
+    lo = glm::min(lo, box.p);
+    hi = glm::max(hi, box.p + box.dims);
+  }
+  profiler_.Count(kCounterPixels, pixels);
+  // Boxes with no area are skipped by every backend, and may be all there is.
+  if (pixels == 0) return;
+  MarkDirty(target, lo, hi - lo);
+  if (is_software()) {
+    const PixelView dst = TargetPixels(target);
+    for (int i = 0; i < boxes.size(); ++i) {
+      const Color32 box_color = colors.empty() ? color : colors[i];
+      if (fill) {
+        raster::FillRect(dst, boxes[i].p, boxes[i].dims, box_color);
+      } else {
+        raster::Rect(dst, boxes[i].p, boxes[i].dims, box_color);
+      }
+    }
+    return;
+  }
+  FlushDraws();
+  if (!colors.empty()) {
+    batch_vertices_.clear();
+    batch_indices_.clear();
+    for (int i = 0; i < boxes.size(); ++i) {
+      const ivec2 p = boxes[i].p;
+      const ivec2 dims = boxes[i].dims;
+      if ((dims.x <= 0) || (dims.y <= 0)) continue;
+      if (fill) {
+        AppendColoredQuad(batch_vertices_, batch_indices_,
+                          {p.x, p.y, dims.x, dims.y}, colors[i]);
+        continue;
+      }
+      // The edges, as raster::Rect draws them, so no pixel is blended twice.
+      AppendColoredQuad(batch_vertices_, batch_indices_, {p.x, p.y, dims.x, 1},
+                        colors[i]);
+      if (dims.y == 1) continue;
+      AppendColoredQuad(batch_vertices_, batch_indices_,
+                        {p.x, p.y + dims.y - 1, dims.x, 1}, colors[i]);
+      if (dims.y == 2) continue;
+      AppendColoredQuad(batch_vertices_, batch_indices_,
+                        {p.x, p.y + 1, 1, dims.y - 2}, colors[i]);
+      if (dims.x == 1) continue;
+      AppendColoredQuad(batch_vertices_, batch_indices_,
+                        {p.x + dims.x - 1, p.y + 1, 1, dims.y - 2}, colors[i]);
+    }
+    SubmitColoredQuads(target);
+    return;
+  }
+  batch_rects_.clear();
+  for (const Box& box : boxes) {
+    if ((box.dims.x <= 0) || (box.dims.y <= 0)) continue;
+    batch_rects_.push_back({box.p.x, box.p.y, box.dims.x, box.dims.y});
+  }
+  SetRenderTarget(TargetTexture(target));
+  SetRenderColor(color);
+  profiler_.CountSubmission(nullptr);
+  if (fill) {
+    CHECK_EQ(SDL_RenderFillRects(renderer_.get(), batch_rects_.data(),
+                                 batch_rects_.size()),
+             0)
+        << "SDL error (SDL_RenderFillRects): " << SDL_GetError();
+  } else {
+    CHECK_EQ(SDL_RenderRects(renderer_.get(), batch_rects_.data(),
+                             batch_rects_.size()),
+             0)
+        << "SDL error (SDL_RenderRects): " << SDL_GetError();
+  }
+}
+
+void Gfx::SubmitColoredQuads(const Image* target) {
+  if (batch_indices_.empty()) return;
+  SetRenderTarget(TargetTexture(target));
+  profiler_.CountSubmission(nullptr);
+  CHECK_EQ(SDL_RenderGeometry(renderer_.get(), nullptr, batch_vertices_.data(),
+                              batch_vertices_.size(), batch_indices_.data(),
+                              batch_indices_.size()),
+           0)
+      << "SDL error (SDL_RenderGeometry): " << SDL_GetError();
+}
+
 // Put & PutEx
 
 void Gfx::Put(const Image& src, ivec2 p, ivec2 src_a, ivec2 src_b) {
   CheckInit(__func__);
-  InternalPut(nullptr, src.texture_.get(), {src.width(), src.height()}, p,
-              PutOptions(), src_a, src_b);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  InternalPut(nullptr, src, p, PutOptions(), src_a, src_b);
 }
 void Gfx::Put(const Image& target, const Image& src, ivec2 p, ivec2 src_a,
               ivec2 src_b) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
   target.CheckTarget(__func__);
-  InternalPut(target.texture_.get(), src.texture_.get(),
-              {src.width(), src.height()}, p, PutOptions(), src_a, src_b);
+  InternalPut(&target, src, p, PutOptions(), src_a, src_b);
 }
 
 void Gfx::PutEx(const Image& src, ivec2 p, PutOptions opts, ivec2 src_a,
                 ivec2 src_b) {
   CheckInit(__func__);
-  InternalPut(nullptr, src.texture_.get(), {src.width(), src.height()}, p, opts,
-              src_a, src_b);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  InternalPut(nullptr, src, p, opts, src_a, src_b);
 }
 void Gfx::PutEx(const Image& target, const Image& src, ivec2 p, PutOptions opts,
                 ivec2 src_a, ivec2 src_b) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
   target.CheckTarget(__func__);
-  InternalPut(target.texture_.get(), src.texture_.get(),
-              {src.width(), src.height()}, p, opts, src_a, src_b);
+  InternalPut(&target, src, p, opts, src_a, src_b);
 }
 
-inline SDL_BlendMode GetSdlBlendMode(Gfx::PutOptions::BlendMode m) {
-  switch (m) {
-    case Gfx::PutOptions::kBlendNone:
-      return SDL_BLENDMODE_NONE;
-    case Gfx::PutOptions::kBlendAlpha:
-      return SDL_BLENDMODE_BLEND;
-    case Gfx::PutOptions::kBlendAdd:
-      return SDL_BLENDMODE_ADD;
-    case Gfx::PutOptions::kBlendMod:
-      return SDL_BLENDMODE_MOD;
-    default:
-      CHECK(false) << "Not a real blend mode: " << m;
+void Gfx::Put(const SubImage& src, ivec2 p, ivec2 src_a, ivec2 src_b) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  ResolveSubImage(src, src_a, src_b);
+  InternalPut(nullptr, *src.image, p, PutOptions(), src_a, src_b);
+}
+void Gfx::Put(const Image& target, const SubImage& src, ivec2 p, ivec2 src_a,
+              ivec2 src_b) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  target.CheckTarget(__func__);
+  ResolveSubImage(src, src_a, src_b);
+  InternalPut(&target, *src.image, p, PutOptions(), src_a, src_b);
+}
+
+void Gfx::PutEx(const SubImage& src, ivec2 p, PutOptions opts, ivec2 src_a,
+                ivec2 src_b) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  ResolveSubImage(src, src_a, src_b);
+  InternalPut(nullptr, *src.image, p, opts, src_a, src_b);
+}
+void Gfx::PutEx(const Image& target, const SubImage& src, ivec2 p,
+                PutOptions opts, ivec2 src_a, ivec2 src_b) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  target.CheckTarget(__func__);
+  ResolveSubImage(src, src_a, src_b);
+  InternalPut(&target, *src.image, p, opts, src_a, src_b);
+}
+
+SDL_FRect Gfx::SourceRect(const Image& src, ivec2 src_a, ivec2 src_b) {
+  if ((src_a.x == -1) || (src_a.y == -1) || (src_b.x == -1) ||
+      (src_b.y == -1)) {
+    return {0, 0, src.width(), src.height()};
   }
+  if (src_a.x > src_b.x) std::swap(src_a.x, src_b.y);
+  if (src_a.y > src_b.y) std::swap(src_a.y, src_b.y);
+  return {src_a.x, src_a.y, src_b.x - src_a.x + 1, src_b.y - src_a.y + 1};
 }
 
-void Gfx::InternalPut(SDL_Texture* dest, SDL_Texture* src, ivec2 src_dims,
-                      ivec2 p, PutOptions opts, ivec2 src_a, ivec2 src_b) {
-  SetRenderTarget(dest);
+void Gfx::InternalPut(const Image* target, const Image& src, ivec2 p,
+                      PutOptions opts, ivec2 src_a, ivec2 src_b) {
+  DCHECK(!src.is_locked()) << "Locked images can't be drawn.";
+  DrawCommand command{TargetTexture(target), &src, opts.blend, opts.mod,
+                      SourceRect(src, src_a, src_b)};
+  command.dst_rect = {p.x, p.y, command.src_rect.w, command.src_rect.h};
+  profiler_.Count(kCounterDrawOps);
+  if (OffTarget(TargetSize(target), p.x, p.y,
+                {command.src_rect.w, command.src_rect.h})) {
+    return;
+  }
+  profiler_.Count(kCounterPixels, command.src_rect.w * command.src_rect.h);
+  MarkDirty(target, p, {command.src_rect.w, command.src_rect.h});
+
+  if (is_software()) {
+    raster::Blit(TargetPixels(target), p, src.pixel_view(),
+                 {command.src_rect.x, command.src_rect.y},
+                 {command.src_rect.w, command.src_rect.h}, opts.blend,
+                 opts.mod);
+    return;
+  }
+  if (deferred_) {
+    RecordDraw(command);
+    return;
+  }
+  profiler_.CountSubmission(&src);
 
-  CHECK_EQ(SDL_SetTextureBlendMode(src, GetSdlBlendMode(opts.blend)), 0)
-      << "SDL error (SDL_SetTextureBlendMode): " << SDL_GetError();
-  CHECK_EQ(SDL_SetTextureColorMod(src, opts.mod.channel.r, opts.mod.channel.g,
-                                  opts.mod.channel.b),
+  SetRenderTarget(command.target);
+  SetTextureBlendMode(src, opts.blend);
+  SetTextureMod(src, opts.mod);
+
+  CHECK_EQ(SDL_RenderTexture(renderer_.get(), src.texture_.get(),
+                             &command.src_rect, &command.dst_rect),
            0)
-      << "SDL error (SDL_SetTextureColorMod): " << SDL_GetError();
-  CHECK_EQ(SDL_SetTextureAlphaMod(src, opts.mod.channel.a), 0)
-      << "SDL error (SDL_SetTextureAlphaMod): " << SDL_GetError();
+      << "SDL error (SDL_RenderTexture): " << SDL_GetError();
+}
 
-  SDL_FRect dst_rect;
-  SDL_FRect src_rect;
+void Gfx::PutBatch(const Image& src, const float* xs, const float* ys, int n,
+                   PutOptions opts, ivec2 src_a, ivec2 src_b) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  InternalPutBatch(nullptr, src, xs, ys, n, opts, src_a, src_b);
+}
+void Gfx::PutBatch(const Image& target, const Image& src, const float* xs,
+                   const float* ys, int n, PutOptions opts, ivec2 src_a,
+                   ivec2 src_b) {
+  CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionPut);
+  target.CheckTarget(__func__);
+  InternalPutBatch(&target, src, xs, ys, n, opts, src_a, src_b);
+}
 
-  dst_rect.x = p.x;
-  dst_rect.y = p.y;
+void Gfx::InternalPutBatch(const Image* target, const Image& src,
+                           const float* xs, const float* ys, int n,
+                           PutOptions opts, ivec2 src_a, ivec2 src_b) {
+  if (n <= 0) return;
+  DCHECK(!src.is_locked()) << "Locked images can't be drawn.";
+  const SDL_FRect src_rect = SourceRect(src, src_a, src_b);
+  profiler_.Count(kCounterDrawOps, n);
+  // Pixels are counted for the copies that aren't culled, below.
+  const uint64_t copy_pixels = static_cast<uint64_t>(src_rect.w * src_rect.h);
+  if ((target == nullptr) && dirty_tracking_) {
+    // The batch is marked by its bounds, positions truncating like below.
+    const auto [x_lo, x_hi] = std::minmax_element(xs, xs + n);
+    const auto [y_lo, y_hi] = std::minmax_element(ys, ys + n);
+    const ivec2 lo(*x_lo, *y_lo);
+    const ivec2 hi(*x_hi, *y_hi);
+    MarkDirty(target, lo, hi - lo + ivec2(src_rect.w, src_rect.h));
+  }
 
-  const SDL_FRect* src_rect_target = &src_rect;
-  if ((src_a.x == -1) || (src_a.y == -1) || (src_b.x == -1) ||
-      (src_b.y == -1)) {
-    src_rect_target = nullptr;
-    dst_rect.w = src_dims.x;
-    dst_rect.h = src_dims.y;
-  } else {
-    if (src_a.x > src_b.x) std::swap(src_a.x, src_b.y);
-    if (src_a.y > src_b.y) std::swap(src_a.y, src_b.y);
-    src_rect.x = src_a.x;
-    src_rect.y = src_a.y;
-    src_rect.w = src_b.x - src_a.x + 1;
-    src_rect.h = src_b.y - src_a.y + 1;
-    dst_rect.w = src_rect.w;
-    dst_rect.h = src_rect.h;
+  const ivec2 target_size = TargetSize(target);
+  const ivec2 dims{src_rect.w, src_rect.h};
+
+  if (is_software()) {
+    const PixelView dst = TargetPixels(target);
+    const PixelView src_pixels = src.pixel_view();
+    const ivec2 src_p{src_rect.x, src_rect.y};
+    int drawn = 0;
+    for (int i = 0; i < n; ++i) {
+      const ivec2 p(xs[i], ys[i]);
+      if (OffTarget(target_size, p.x, p.y, dims)) continue;
+      raster::Blit(dst, p, src_pixels, src_p, dims, opts.blend, opts.mod);
+      ++drawn;
+    }
+    profiler_.Count(kCounterPixels, drawn * copy_pixels);
+    return;
+  }
+  // Anything recorded earlier has to land first, which also frees up
+  // batch_vertices_.
+  FlushDraws();
+
+  const SDL_Color color{opts.mod.channel.r, opts.mod.channel.g,
+                        opts.mod.channel.b, opts.mod.channel.a};
+  const float u0 = src_rect.x / src.width();
+  const float v0 = src_rect.y / src.height();
+  const float u1 = (src_rect.x + src_rect.w) / src.width();
+  const float v1 = (src_rect.y + src_rect.h) / src.height();
+  batch_vertices_.resize(n * 4);
+  SDL_Vertex* vertex = batch_vertices_.data();
+  for (int i = 0; i < n; ++i) {
+    // Truncate like the ivec2 position of Put.
+    const float x0 = static_cast<int>(xs[i]);
+    const float y0 = static_cast<int>(ys[i]);
+    if (OffTarget(target_size, x0, y0, dims)) continue;
+    const float x1 = x0 + src_rect.w;
+    const float y1 = y0 + src_rect.h;
+    vertex[0] = {{x0, y0}, color, {u0, v0}};
+    vertex[1] = {{x1, y0}, color, {u1, v0}};
+    vertex[2] = {{x1, y1}, color, {u1, v1}};
+    vertex[3] = {{x0, y1}, color, {u0, v1}};
+    vertex += 4;
+  }
+  const int quads = (vertex - batch_vertices_.data()) / 4;
+  profiler_.Count(kCounterPixels, quads * copy_pixels);
+  if (quads == 0) return;
+  for (int quad = quad_indices_.size() / 6; quad < quads; ++quad) {
+    for (const int i : {0, 1, 2, 2, 3, 0}) {
+      quad_indices_.push_back(quad * 4 + i);
+    }
   }
 
-  CHECK_EQ(SDL_RenderTexture(renderer_.get(), src, src_rect_target, &dst_rect),
+  SetRenderTarget(TargetTexture(target));
+  SetTextureBlendMode(src, opts.blend);
+  CHECK_EQ(SDL_RenderGeometry(renderer_.get(), src.texture_.get(),
+                              batch_vertices_.data(), quads * 4,
+                              quad_indices_.data(), quads * 6),
            0)
-      << "SDL error (SDL_RenderTexture): " << SDL_GetError();
+      << "SDL error (SDL_RenderGeometry): " << SDL_GetError();
+  profiler_.CountSubmission(&src);
 }
 
 // TextLine
@@ -313,24 +1224,20 @@ void Gfx::InternalPut(SDL_Texture* dest, SDL_Texture* src, ivec2 src_dims,
 void Gfx::TextLine(string_view text, ivec2 p, Color32 color, TextHAlign h_align,
                    TextVAlign v_align) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionTextLine);
   InternalTextLine(nullptr, text, p, color, h_align, v_align);
 }
 void Gfx::TextLine(const Image& target, string_view text, ivec2 p,
                    Color32 color, TextHAlign h_align, TextVAlign v_align) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionTextLine);
   target.CheckTarget(__func__);
-  InternalTextLine(target.texture_.get(), text, p, color, h_align, v_align);
+  InternalTextLine(&target, text, p, color, h_align, v_align);
 }
 
-void Gfx::InternalTextLine(SDL_Texture* texture, string_view text, ivec2 p,
+void Gfx::InternalTextLine(const Image* target, string_view text, ivec2 p,
                            Color32 color, TextHAlign h_align,
                            TextVAlign v_align) {
-  SetRenderTarget(texture);
-  CHECK_EQ(
-      SDL_SetTextureColorMod(basic_font_.get()->texture_.get(), color.channel.r,
-                             color.channel.g, color.channel.b),
-      0)
-      << "SDL error (SDL_SetTextureColorMod): " << SDL_GetError();
   const ivec2 box_dims{text.size() * kTextCharacterDims.x,
                        kTextCharacterDims.y};
   switch (h_align) {
@@ -360,17 +1267,13 @@ void Gfx::InternalTextLine(SDL_Texture* texture, string_view text, ivec2 p,
       CHECK(false) << "Invalid vertical text alignment specified: " << h_align;
   }
 
-  SDL_FRect src_rect{0, 0, kTextCharacterDims.x, kTextCharacterDims.y};
+  MarkDirty(target, p, box_dims);
   SDL_FRect dst_rect{p.x, p.y, kTextCharacterDims.x, kTextCharacterDims.y};
-  SDL_Texture* font_tex = basic_font_.get()->texture_.get();
   for (const char c : text) {
-    src_rect.x = (c & 0x1f) * kTextCharacterDims.x;
-    src_rect.y = (c >> 5) * kTextCharacterDims.y;
-    CHECK_EQ(SDL_RenderTexture(renderer_.get(), font_tex, &src_rect, &dst_rect),
-             0)
-        << "SDL error (SDL_RenderCopy): " << SDL_GetError();
+    InternalGlyph(target, c, dst_rect, color);
     dst_rect.x += kTextCharacterDims.x;
   }
+  SubmitGlyphs(target);
 }
 
 // TextParagraph
@@ -378,25 +1281,20 @@ void Gfx::InternalTextLine(SDL_Texture* texture, string_view text, ivec2 p,
 void Gfx::TextParagraph(string_view text, ivec2 a, ivec2 b, Color32 color,
                         TextHAlign h_align, TextVAlign v_align) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionTextParagraph);
   InternalTextParagraph(nullptr, text, a, b, color, h_align, v_align);
 }
 void Gfx::TextParagraph(const Image& target, string_view text, ivec2 a, ivec2 b,
                         Color32 color, TextHAlign h_align, TextVAlign v_align) {
   CheckInit(__func__);
+  const Profiler::ScopedSection section(profiler_, kSectionTextParagraph);
   target.CheckTarget(__func__);
-  InternalTextParagraph(target.texture_.get(), text, a, b, color, h_align,
-                        v_align);
+  InternalTextParagraph(&target, text, a, b, color, h_align, v_align);
 }
 
-void Gfx::InternalTextParagraph(SDL_Texture* texture, string_view text, ivec2 a,
+void Gfx::InternalTextParagraph(const Image* target, string_view text, ivec2 a,
                                 ivec2 b, Color32 color, TextHAlign h_align,
                                 TextVAlign v_align) {
-  SetRenderTarget(texture);
-  CHECK_EQ(
-      SDL_SetTextureColorMod(basic_font_.get()->texture_.get(), color.channel.r,
-                             color.channel.g, color.channel.b),
-      0)
-      << "SDL error (SDL_SetTextureColorMod): " << SDL_GetError();
   if (a.x > b.x) std::swap(a.x, b.y);
   if (a.y > b.y) std::swap(a.y, b.y);
   const ivec2 box_dims = b - a + ivec2{1, 1};
@@ -423,8 +1321,8 @@ void Gfx::InternalTextParagraph(SDL_Texture* texture, string_view text, ivec2 a,
       CHECK(false) << "Invalid vertical text alignment specified: " << h_align;
   }
 
-  SDL_FRect src_rect{0, 0, kTextCharacterDims.x, kTextCharacterDims.y};
-  SDL_Texture* font_tex = basic_font_.get()->texture_.get();
+  ivec2 drawn_a(std::numeric_limits<int>::max());
+  ivec2 drawn_b(std::numeric_limits<int>::min());
   int cursor = 0;
   while (cursor < text.size()) {
     int space_skip = 1;
@@ -456,24 +1354,69 @@ void Gfx::InternalTextParagraph(SDL_Texture* texture, string_view text, ivec2 a,
                      << h_align;
     }
 
+    // Lines can overhang the box, so the region drawn is their bounds.
+    if (line_term > cursor) {
+      const ivec2 line_a(dst_rect.x, dst_rect.y);
+      const ivec2 line_b = line_a + ivec2(line_width, kTextCharacterDims.y);
+      drawn_a = glm::min(drawn_a, line_a);
+      drawn_b = glm::max(drawn_b, line_b);
+    }
     for (int c_i = cursor; c_i < line_term; ++c_i) {
-      const char c = text[c_i];
-      src_rect.x = (c & 0x1f) * kTextCharacterDims.x;
-      src_rect.y = (c >> 5) * kTextCharacterDims.y;
-      CHECK_EQ(
-          SDL_RenderTexture(renderer_.get(), font_tex, &src_rect, &dst_rect), 0)
-          << "SDL error (SDL_RenderCopy): " << SDL_GetError();
+      InternalGlyph(target, text[c_i], dst_rect, color);
       dst_rect.x += kTextCharacterDims.x;
     }
 
     cursor = line_term + space_skip;
     dst_rect.y += kTextCharacterDims.y;
   }
+  SubmitGlyphs(target);
+  if (drawn_a.x <= drawn_b.x) MarkDirty(target, drawn_a, drawn_b - drawn_a);
+}
+
+// Glyphs
+
+void Gfx::InternalGlyph(const Image* target, char c, SDL_FRect dst_rect,
+                        Color32 color) {
+  const Glyph& glyph = glyphs_[static_cast<uint8_t>(c)];
+  profiler_.Count(kCounterDrawOps);
+  profiler_.Count(kCounterPixels, kTextCharacterDims.x * kTextCharacterDims.y);
+  if (is_software()) {
+    raster::Blit(TargetPixels(target), {dst_rect.x, dst_rect.y},
+                 basic_font_->pixel_view(),
+                 {glyph.src_rect.x, glyph.src_rect.y}, kTextCharacterDims,
+                 PutOptions::kBlendAlpha, color | 0xff);
+    return;
+  }
+  if (deferred_) {
+    RecordDraw({TargetTexture(target), basic_font_.get(),
+                PutOptions::kBlendAlpha, color | 0xff, glyph.src_rect,
+                dst_rect});
+    return;
+  }
+  const Color32 mod = color | 0xff;
+  AppendQuad(glyph_vertices_, glyph_indices_, dst_rect, glyph.u0, glyph.v0,
+             glyph.u1, glyph.v1,
+             {mod.channel.r, mod.channel.g, mod.channel.b, mod.channel.a});
+}
+
+void Gfx::SubmitGlyphs(const Image* target) {
+  if (glyph_indices_.empty()) return;
+  SetRenderTarget(TargetTexture(target));
+  SetTextureBlendMode(*basic_font_, PutOptions::kBlendAlpha);
+  CHECK_EQ(SDL_RenderGeometry(renderer_.get(), basic_font_->texture_.get(),
+                              glyph_vertices_.data(), glyph_vertices_.size(),
+                              glyph_indices_.data(), glyph_indices_.size()),
+           0)
+      << "SDL error (SDL_RenderGeometry): " << SDL_GetError();
+  profiler_.CountSubmission(basic_font_.get());
+  glyph_vertices_.clear();
+  glyph_indices_.clear();
 }
 
 bool Gfx::GetKeyPressed(Key key) {
   CheckInit(__func__);
-  return SDL_GetKeyboardState(nullptr)[key];
+  const SDL_Scancode scancode = static_cast<SDL_Scancode>(key);
+  return input_.IsKeyDown(scancode) || input_.WasKeyPressed(scancode);
 }
 
 const std::tuple<glm::ivec3, Gfx::MouseButtonPressedState&> Gfx::GetMouse() {
@@ -490,8 +1433,10 @@ void Gfx::SyncInputs() {
   close_pressed_ = false;
   mouse_button_state_ = {false, false, false};
   ++input_cycle_;
+  input_.BeginFrame();
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
+    input_.Record(event);
     switch (event.type) {
       case SDL_EVENT_QUIT:
         close_pressed_ = true;
@@ -523,5 +1468,16 @@ void Gfx::HandleMouseButtonEvent(SDL_Event event) {
       return;
   }
 }
+
+namespace internal {
+
+// Indexed by the unsigned byte: with a signed char, bytes from 0x80 would land
+// on negative rows.
+ivec2 GlyphOrigin(uint8_t c) {
+  return ivec2(c & 0x1f, c >> 5) * kTextCharacterDims;
+}
+
+}  // namespace internal
+
 }  // namespace gfx
 }  // namespace land15
\ No newline at end of file
@@ -1,11 +1,19 @@
 #ifndef LAND15_GFX_GFX_H_
 #define LAND15_GFX_GFX_H_
 
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
 #include "common/deleter_ptr.h"
 #include "gfx/core.h"
+#include "gfx/input.h"
+#include "gfx/profiler.h"
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glog/logging.h"
@@ -21,16 +29,30 @@ namespace gfx {
 constexpr char kSystemFontPath[] = "res/system_font_.png";
 
 class Image;
+struct SubImage;
 class Gfx final {
   friend class Image;
 
  public:
+  enum Backend {
+    // Draws with a hardware accelerated SDL_Renderer.
+    kBackendAccelerated = 0,
+    // Rasterizes on the CPU into system memory Images, uploading the screen to
+    // the window on Flip().
+    kBackendSoftware = 1,
+    // Like kBackendSoftware, but never opens a window.
+    kBackendHeadless = 2
+  };
+
   // Must be called to use graphics functionality, can only be called once.
   // Resolution is the physical resolution of the drawing area whereas the
   // logical resolution is the resolution at which the pixels are displayed.
   static void Screen(glm::ivec2 res, bool fullscreen = false,
                      const std::string& title = "Title",
-                     glm::ivec2 physical_res = {-1, -1});
+                     glm::ivec2 physical_res = {-1, -1},
+                     Backend backend = kBackendAccelerated);
+
+  static Backend GetBackend();
 
   // Clear the screen (optionally to a color)
   static void Cls(Color32 col = Color32::kBlack);
@@ -41,11 +63,53 @@ class Gfx final {
   static bool IsFullscreen();
   static void SetFullscreen(bool fullscreen);
 
-  // Updates the screen after waiting for vsync, clobbering the back buffer
-  // in the process (be sure to ClS if you don't plan on overwriting the whole
-  // backbuffer)
+  // Whether Flip() waits for vsync, which it does by default. Turn it off when
+  // pacing frames some other way, or Flip() waits on both. Has no effect
+  // without a window.
+  static bool IsVSync();
+  static void SetVSync(bool vsync);
+
+  // Updates the screen after waiting for vsync (if enabled), clobbering the
+  // back buffer in the process (be sure to ClS if you don't plan on
+  // overwriting the whole backbuffer), unless dirty tracking is enabled.
   static void Flip();
 
+  // When enabled, the screen keeps its contents from one frame to the next,
+  // and Flip() only updates the regions drawn to since the last Flip(). A
+  // mostly static screen then only needs to redraw what changed, and costs
+  // next to nothing when nothing did. The profile overlay is drawn into the
+  // kept screen like anything else.
+  static void SetDirtyTracking(bool enabled);
+  static bool IsDirtyTracking() { return dirty_tracking_; }
+
+  // The fraction of the screen updated by the last Flip(), always 1 without
+  // dirty tracking.
+  static float GetUpdatedFraction() { return updated_fraction_; }
+
+  // When deferred, Put/PutEx and text glyphs are recorded into a command buffer
+  // instead of being submitted immediately. Has no effect unless the backend
+  // is kBackendAccelerated. On flush, runs of consecutive
+  // commands sharing a target, source texture and blend mode are submitted as
+  // a single SDL_RenderGeometry call. The buffer is flushed by Flip(),
+  // FlushDraws() and by any drawing call that can't be deferred, so the result
+  // is always the same as in immediate mode.
+  static void SetDeferred(bool deferred);
+  static bool IsDeferred() { return deferred_; }
+
+  // Submits any recorded draw commands. Does nothing in immediate mode.
+  static void FlushDraws();
+
+  // Returns the per-frame counters and timings of Gfx calls, which roll over
+  // to a new frame on every Flip().
+  static const Profiler& GetProfiler() { return profiler_; }
+
+  // Sets the number of frames the profile statistics are computed over.
+  static void SetProfileWindow(int frames);
+
+  // When enabled, Flip() draws a summary of the profile over the screen using
+  // the system font.
+  static void SetProfileOverlay(bool enabled);
+
   static void PSet(glm::ivec2 p, Color32 color = Color32::kWhite);
   static void PSet(const Image& target, glm::ivec2 p,
                    Color32 color = Color32::kWhite);
@@ -63,6 +127,55 @@ class Gfx final {
   static void FillRect(const Image& target, glm::ivec2 a, glm::ivec2 b,
                        Color32 color = Color32::kWhite);
 
+  // A line from `a` to `b`, as drawn by Line().
+  struct Segment {
+    glm::ivec2 a;
+    glm::ivec2 b;
+  };
+  // The `dims` sized rect with its top left corner at `p`, as drawn by Rect()
+  // and FillRect().
+  struct Box {
+    glm::ivec2 p;
+    glm::ivec2 dims;
+  };
+
+  // Batches of primitives, each batch drawn in a single submission, in one
+  // color or with a color per item. SDL has no call for separate line
+  // segments, so those are drawn as points.
+  static void PSet(std::span<const glm::ivec2> points,
+                   Color32 color = Color32::kWhite);
+  static void PSet(std::span<const glm::ivec2> points,
+                   std::span<const Color32> colors);
+  static void PSet(const Image& target, std::span<const glm::ivec2> points,
+                   Color32 color = Color32::kWhite);
+  static void PSet(const Image& target, std::span<const glm::ivec2> points,
+                   std::span<const Color32> colors);
+
+  static void Line(std::span<const Segment> segments,
+                   Color32 color = Color32::kWhite);
+  static void Line(std::span<const Segment> segments,
+                   std::span<const Color32> colors);
+  static void Line(const Image& target, std::span<const Segment> segments,
+                   Color32 color = Color32::kWhite);
+  static void Line(const Image& target, std::span<const Segment> segments,
+                   std::span<const Color32> colors);
+
+  static void Rect(std::span<const Box> boxes, Color32 color = Color32::kWhite);
+  static void Rect(std::span<const Box> boxes, std::span<const Color32> colors);
+  static void Rect(const Image& target, std::span<const Box> boxes,
+                   Color32 color = Color32::kWhite);
+  static void Rect(const Image& target, std::span<const Box> boxes,
+                   std::span<const Color32> colors);
+
+  static void FillRect(std::span<const Box> boxes,
+                       Color32 color = Color32::kWhite);
+  static void FillRect(std::span<const Box> boxes,
+                       std::span<const Color32> colors);
+  static void FillRect(const Image& target, std::span<const Box> boxes,
+                       Color32 color = Color32::kWhite);
+  static void FillRect(const Image& target, std::span<const Box> boxes,
+                       std::span<const Color32> colors);
+
   enum TextHAlign {
     kTextAlignHLeft = 0,
     kTextAlignHCenter = 1,
@@ -117,6 +230,30 @@ class Gfx final {
                     PutOptions opts, glm::ivec2 src_a = {-1, -1},
                     glm::ivec2 src_b = {-1, -1});
 
+  // Draws from a SubImage (like an atlas entry), `src_a` and `src_b` being
+  // relative to it and within it. By default the whole SubImage is drawn.
+  static void Put(const SubImage& src, glm::ivec2 p,
+                  glm::ivec2 src_a = {-1, -1}, glm::ivec2 src_b = {-1, -1});
+  static void Put(const Image& target, const SubImage& src, glm::ivec2 p,
+                  glm::ivec2 src_a = {-1, -1}, glm::ivec2 src_b = {-1, -1});
+  static void PutEx(const SubImage& src, glm::ivec2 p, PutOptions opts,
+                    glm::ivec2 src_a = {-1, -1}, glm::ivec2 src_b = {-1, -1});
+  static void PutEx(const Image& target, const SubImage& src, glm::ivec2 p,
+                    PutOptions opts, glm::ivec2 src_a = {-1, -1},
+                    glm::ivec2 src_b = {-1, -1});
+
+  // Draws the same region of `src` at each of `n` positions, given as separate
+  // x and y arrays and truncated to whole pixels. The whole batch is a single
+  // submission, so this is the way to draw many copies of a sprite. Copies
+  // entirely off the target are skipped.
+  static void PutBatch(const Image& src, const float* xs, const float* ys,
+                       int n, PutOptions opts, glm::ivec2 src_a = {-1, -1},
+                       glm::ivec2 src_b = {-1, -1});
+  static void PutBatch(const Image& target, const Image& src, const float* xs,
+                       const float* ys, int n, PutOptions opts,
+                       glm::ivec2 src_a = {-1, -1},
+                       glm::ivec2 src_b = {-1, -1});
+
   // Updates the internal state from a queue of the inputs triggered since the
   // last call to SyncInputs. This must be called before calls to GetMouse or
   // GetKeyPressed.
@@ -143,9 +280,14 @@ class Gfx final {
   };
 
   // Returns true if the given key is currently pressed as of the last call to
-  // SyncInputs()
+  // SyncInputs(), or was pressed since the call before, so that a key tapped
+  // within a frame isn't missed.
   static bool GetKeyPressed(Key key);
 
+  // Every input event along with the state of all keys and mouse buttons, as
+  // of the last call to SyncInputs().
+  static const Input& GetInput() { return input_; }
+
   // Returns true if the close button was pressed since the last call to
   // SyncInputs()
   static bool Close();
@@ -155,38 +297,146 @@ class Gfx final {
   static void CheckInit(std::string_view meth_name) {
     CHECK(is_init()) << "Cannot call " << meth_name << " before FbGfx::Screen.";
   }
+  static void CheckWindow(std::string_view meth_name) {
+    CHECK(window_.get() != nullptr)
+        << "Cannot call " << meth_name << " without a window.";
+  }
 
+  static void OpenWindow(glm::ivec2 res, bool fullscreen,
+                         const std::string& title, glm::ivec2 physical_res);
   static void PrepareFont();
 
-  // Using SetRender* methods assumes that CheckInit has already been called.
+  // Using SetRender*/SetTexture* methods assumes that CheckInit has already
+  // been called. They are skipped if the shadowed state is already current.
   static void SetRenderTarget(SDL_Texture* target);
   static void SetRenderColor(Color32 col);
+  static void SetTextureBlendMode(const Image& image,
+                                  PutOptions::BlendMode blend);
+  static void SetTextureMod(const Image& image, Color32 mod);
 
-  static void InternalCls(SDL_Texture* texture, Color32 col);
-  static void InternalPSet(SDL_Texture* texture, glm::ivec2 p, Color32 color);
-  static void InternalLine(SDL_Texture* texture, glm::ivec2 a, glm::ivec2 b,
+  // Called as an Image is destroyed to drop any state that refers to it.
+  static void ForgetImage(const Image& image);
+
+  static void InternalCls(const Image* target, Color32 col);
+  static void InternalPSet(const Image* target, glm::ivec2 p, Color32 color);
+  static void InternalLine(const Image* target, glm::ivec2 a, glm::ivec2 b,
                            Color32 color);
-  static void InternalRect(SDL_Texture* texture, glm::ivec2 a, glm::ivec2 b,
+  static void InternalRect(const Image* target, glm::ivec2 a, glm::ivec2 b,
                            Color32 color);
-  static void InternalFillRect(SDL_Texture* texture, glm::ivec2 a, glm::ivec2 b,
+  static void InternalFillRect(const Image* target, glm::ivec2 a, glm::ivec2 b,
                                Color32 color);
-  static void InternalPut(SDL_Texture* dest, SDL_Texture* src,
-                          glm::ivec2 src_dims, glm::ivec2 p, PutOptions opts,
-                          glm::ivec2 src_a, glm::ivec2 src_b);
-  static void InternalTextLine(SDL_Texture* texture, std::string_view text,
+  // The batch primitives, in `color` unless `colors` isn't empty.
+  static void InternalPSets(const Image* target,
+                            std::span<const glm::ivec2> points, Color32 color,
+                            std::span<const Color32> colors);
+  static void InternalLines(const Image* target,
+                            std::span<const Segment> segments, Color32 color,
+                            std::span<const Color32> colors);
+  static void InternalRects(const Image* target, std::span<const Box> boxes,
+                            bool fill, Color32 color,
+                            std::span<const Color32> colors);
+  // Draws the untextured quads in batch_vertices_ and batch_indices_.
+  static void SubmitColoredQuads(const Image* target);
+  static void InternalPut(const Image* target, const Image& src, glm::ivec2 p,
+                          PutOptions opts, glm::ivec2 src_a, glm::ivec2 src_b);
+  static void InternalPutBatch(const Image* target, const Image& src,
+                               const float* xs, const float* ys, int n,
+                               PutOptions opts, glm::ivec2 src_a,
+                               glm::ivec2 src_b);
+  // The region of `src` drawn by a Put, -1 coordinates meaning all of it.
+  static SDL_FRect SourceRect(const Image& src, glm::ivec2 src_a,
+                              glm::ivec2 src_b);
+  static void InternalTextLine(const Image* target, std::string_view text,
                                glm::ivec2 p, Color32 color, TextHAlign h_align,
                                TextVAlign v_align);
-  static void InternalTextParagraph(SDL_Texture* texture, std::string_view text,
+  static void InternalTextParagraph(const Image* target, std::string_view text,
                                     glm::ivec2 a, glm::ivec2 b, Color32 color,
                                     TextHAlign h_align, TextVAlign v_align);
 
-  static bool is_init() { return window_.get() != nullptr; }
+  // Draws character `c` of the system font. In immediate accelerated mode, the
+  // glyph is only queued, and the caller must then call SubmitGlyphs() with the
+  // same target to draw every queued glyph in a single call.
+  static void InternalGlyph(const Image* target, char c, SDL_FRect dst_rect,
+                            Color32 color);
+  static void SubmitGlyphs(const Image* target);
+
+  // Source rect and texture coordinates of each character of the system font,
+  // built by PrepareFont().
+  struct Glyph {
+    SDL_FRect src_rect;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+  };
+  static Glyph glyphs_[256];
+  static std::vector<SDL_Vertex> glyph_vertices_;
+  static std::vector<int> glyph_indices_;
+
+  // Resolve the target of a drawing operation, nullptr being the screen.
+  static SDL_Texture* TargetTexture(const Image* target);
+  static PixelView TargetPixels(const Image* target);
+  static glm::ivec2 TargetSize(const Image* target);
+
+  // A single deferred textured quad.
+  struct DrawCommand {
+    SDL_Texture* target;
+    const Image* src;
+    PutOptions::BlendMode blend;
+    Color32 mod;
+    SDL_FRect src_rect;
+    SDL_FRect dst_rect;
+  };
+  static void RecordDraw(const DrawCommand& command);
+  static void SubmitBatch(const DrawCommand* begin, const DrawCommand* end);
+
+  static bool deferred_;
+  static std::vector<DrawCommand> draw_commands_;
+  static std::vector<SDL_Vertex> batch_vertices_;
+  static std::vector<int> batch_indices_;
+  // Indices of consecutive quads, shared by every PutBatch and only ever
+  // grown.
+  static std::vector<int> quad_indices_;
+  // Single colored batches of primitives.
+  static std::vector<SDL_FPoint> batch_points_;
+  static std::vector<SDL_FRect> batch_rects_;
+
+  // Records that the `dims` sized region at `p` of `target` was drawn to, if
+  // it's the screen and dirty tracking is enabled.
+  static void MarkDirty(const Image* target, glm::ivec2 p, glm::ivec2 dims);
+  // Regions of the screen drawn to since the last Flip(), clipped to it and
+  // merged down to at most kMaxDirtyRects_.
+  static constexpr int kMaxDirtyRects_ = 16;
+  static bool dirty_tracking_;
+  static std::vector<SDL_Rect> dirty_rects_;
+  static float updated_fraction_;
+
+  static bool is_init() { return is_init_; }
+  static bool is_software() { return backend_ != kBackendAccelerated; }
+  static bool is_init_;
+  static Backend backend_;
+  static glm::ivec2 resolution_;
   static common::deleter_ptr<SDL_Window> window_;
   static common::deleter_ptr<SDL_Renderer> renderer_;
 
+  // Used by the software backends: the screen image, and the texture it's
+  // uploaded to for display. Under kBackendAccelerated, screen_ is only used
+  // with dirty tracking, as the render target kept across frames.
+  static std::unique_ptr<Image> screen_;
+  static common::deleter_ptr<SDL_Texture> screen_texture_;
+
   static std::unique_ptr<Image> basic_font_;
 
+  // Shadowed renderer state, empty when unknown.
+  static std::optional<SDL_Texture*> render_target_;
+  static std::optional<int32_t> render_color_;
+
+  static Profiler profiler_;
+  static bool profile_overlay_;
+  static void DrawProfileOverlay();
+
   static uint32_t input_cycle_;
+  static Input input_;
 
   static void HandleMouseButtonEvent(SDL_Event event);
 
@@ -200,6 +450,14 @@ class Gfx final {
   static Cleanup cleanup_;
 };
 
+namespace internal {
+
+// The top left pixel of the glyph of byte `c` in the system font, which has 8
+// rows of 32 glyphs.
+glm::ivec2 GlyphOrigin(uint8_t c);
+
+}  // namespace internal
+
 }  // namespace gfx
 }  // namespace land15
 
@@ -0,0 +1,41 @@
+#include "gfx/gfx.h"
+
+#include <stdint.h>
+
+#include "glm/vec2.hpp"
+#include "gtest/gtest.h"
+
+namespace land15 {
+namespace gfx {
+namespace {
+
+// The system font is 256x64: 8 rows of 32 glyphs of 8x8.
+constexpr int kFontWidth = 256;
+constexpr int kFontHeight = 64;
+
+TEST(GfxTest, GlyphOrigins) {
+  EXPECT_EQ(internal::GlyphOrigin(0x00), glm::ivec2(0, 0));
+  EXPECT_EQ(internal::GlyphOrigin('A'), glm::ivec2(8, 16));
+  EXPECT_EQ(internal::GlyphOrigin(0x80), glm::ivec2(0, 32));
+  EXPECT_EQ(internal::GlyphOrigin(0xff), glm::ivec2(248, 56));
+}
+
+TEST(GfxTest, EveryByteHasAGlyphInTheFont) {
+  bool seen[kFontWidth / 8][kFontHeight / 8] = {};
+  for (int i = 0; i < 256; ++i) {
+    // As text hands the glyphs its chars, which may be signed.
+    const char c = static_cast<char>(i);
+    const glm::ivec2 origin = internal::GlyphOrigin(c);
+    ASSERT_GE(origin.x, 0) << "Byte " << i;
+    ASSERT_GE(origin.y, 0) << "Byte " << i;
+    ASSERT_LE(origin.x + 8, kFontWidth) << "Byte " << i;
+    ASSERT_LE(origin.y + 8, kFontHeight) << "Byte " << i;
+    bool& glyph = seen[origin.x / 8][origin.y / 8];
+    EXPECT_FALSE(glyph) << "Byte " << i << " shares a glyph.";
+    glyph = true;
+  }
+}
+
+}  // namespace
+}  // namespace gfx
+}  // namespace land15
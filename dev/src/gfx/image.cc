@@ -4,8 +4,14 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "gfx/gfx.h"
+#include "gfx/pack.h"
+#include "glm/common.hpp"
+#include "glm/vec2.hpp"
 #include "glog/logging.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "common/deleter_ptr.h"
@@ -18,13 +24,39 @@ using common::deleter_ptr;
 using glm::ivec2;
 using std::string;
 using std::unique_ptr;
+using std::vector;
 
 Image::Image(deleter_ptr<SDL_Texture> texture, int w, int h, bool is_target)
     : texture_(std::move(texture)), w_(w), h_(h), is_target_(is_target) {}
 
+Image::Image(vector<Color32> pixels, int w, int h, bool is_target)
+    : texture_(nullptr),
+      pixels_(std::move(pixels)),
+      w_(w),
+      h_(h),
+      is_target_(is_target) {}
+
+Image::Image(deleter_ptr<SDL_Texture> texture, vector<Color32> pixels, int w,
+             int h)
+    : texture_(std::move(texture)),
+      pixels_(std::move(pixels)),
+      w_(w),
+      h_(h),
+      is_target_(false),
+      is_streaming_(true) {}
+
+Image::~Image() { Gfx::ForgetImage(*this); }
+
 unique_ptr<Image> Image::OfSize(ivec2 dimensions) {
   Gfx::CheckInit(__func__);
 
+  if (Gfx::is_software()) {
+    vector<Color32> pixels(dimensions.x * dimensions.y,
+                           Color32::kTransparentBlack);
+    return unique_ptr<Image>(
+        new Image(std::move(pixels), dimensions.x, dimensions.y, true));
+  }
+
   deleter_ptr<SDL_Texture> texture(
       SDL_CreateTexture(Gfx::renderer_.get(), SDL_PIXELFORMAT_RGBA8888,
                         SDL_TEXTUREACCESS_TARGET, dimensions.x, dimensions.y),
@@ -35,6 +67,61 @@ unique_ptr<Image> Image::OfSize(ivec2 dimensions) {
       new Image(std::move(texture), dimensions.x, dimensions.y, true));
 }
 
+unique_ptr<Image> Image::Streaming(ivec2 dimensions) {
+  Gfx::CheckInit(__func__);
+
+  vector<Color32> pixels(dimensions.x * dimensions.y,
+                         Color32::kTransparentBlack);
+  if (Gfx::is_software()) {
+    return unique_ptr<Image>(
+        new Image(nullptr, std::move(pixels), dimensions.x, dimensions.y));
+  }
+
+  deleter_ptr<SDL_Texture> texture(
+      SDL_CreateTexture(Gfx::renderer_.get(), SDL_PIXELFORMAT_RGBA8888,
+                        SDL_TEXTUREACCESS_STREAMING, dimensions.x,
+                        dimensions.y),
+      [](SDL_Texture* t) { SDL_DestroyTexture(t); });
+  CHECK_NE(texture.get(), static_cast<SDL_Texture*>(NULL))
+      << "SDL error (SDL_CreateTexture): " << SDL_GetError();
+  CHECK_EQ(SDL_UpdateTexture(texture.get(), nullptr, pixels.data(),
+                             dimensions.x * sizeof(Color32)),
+           0)
+      << "SDL error (SDL_UpdateTexture): " << SDL_GetError();
+  return unique_ptr<Image>(new Image(std::move(texture), std::move(pixels),
+                                     dimensions.x, dimensions.y));
+}
+
+PixelView Image::Lock() { return Lock({0, 0}, {w_ - 1, h_ - 1}); }
+
+PixelView Image::Lock(ivec2 a, ivec2 b) {
+  CHECK(is_streaming_) << "Only streaming images can be locked.";
+  CHECK(!locked_) << "Image is already locked.";
+  lock_a_ = glm::max(glm::min(a, b), ivec2(0, 0));
+  lock_b_ = glm::min(glm::max(a, b), ivec2(w_ - 1, h_ - 1));
+  CHECK((lock_a_.x <= lock_b_.x) && (lock_a_.y <= lock_b_.y))
+      << "Locked region is outside of the image.";
+  locked_ = true;
+  const ivec2 dims = lock_b_ - lock_a_ + 1;
+  return {pixels_.data() + lock_a_.y * w_ + lock_a_.x, dims.x, dims.y, w_};
+}
+
+void Image::Unlock() {
+  CHECK(locked_) << "Image isn't locked.";
+  locked_ = false;
+  if (texture_ == nullptr) return;
+
+  // Deferred draws of the image have to land before it changes.
+  Gfx::FlushDraws();
+  const ivec2 dims = lock_b_ - lock_a_ + 1;
+  const SDL_Rect rect{lock_a_.x, lock_a_.y, dims.x, dims.y};
+  CHECK_EQ(SDL_UpdateTexture(texture_.get(), &rect,
+                             pixels_.data() + lock_a_.y * w_ + lock_a_.x,
+                             w_ * sizeof(Color32)),
+           0)
+      << "SDL error (SDL_UpdateTexture): " << SDL_GetError();
+}
+
 deleter_ptr<SDL_Texture> Image::TextureFromSurface(SDL_Surface* surface) {
   deleter_ptr<SDL_Texture> texture(
       SDL_CreateTextureFromSurface(Gfx::renderer_.get(), surface),
@@ -44,9 +131,77 @@ deleter_ptr<SDL_Texture> Image::TextureFromSurface(SDL_Surface* surface) {
   return std::move(texture);
 }
 
+PixelBuffer Image::DecodeFile(const string& filename) {
+  int w;
+  int h;
+  int orig_format_unused;
+  deleter_ptr<StbImageData> image_data(
+      stbi_load(filename.c_str(), &w, &h, &orig_format_unused, STBI_rgb_alpha),
+      [](StbImageData* d) { stbi_image_free(d); });
+  CHECK_NE(static_cast<void*>(image_data.get()), static_cast<void*>(NULL))
+      << "stb_image error (stbi_load): " << stbi_failure_reason();
+
+  PixelBuffer buffer{w, h};
+  buffer.pixels.reserve(w * h);
+  const StbImageData* data = image_data.get();
+  for (int i = 0; i < w * h; ++i, data += 4) {
+    buffer.pixels.push_back(Color32(data[0], data[1], data[2], data[3]));
+  }
+  return buffer;
+}
+
+unique_ptr<Image> Image::FromPixels(PixelBuffer pixels) {
+  Gfx::CheckInit(__func__);
+
+  if (Gfx::is_software()) {
+    return unique_ptr<Image>(
+        new Image(std::move(pixels.pixels), pixels.w, pixels.h, false));
+  }
+
+  return unique_ptr<Image>(
+      new Image(UploadTexture(pixels.pixels.data(), pixels.w, pixels.h),
+                pixels.w, pixels.h, false));
+}
+
+unique_ptr<Image> Image::FromPack(const ResourcePack& pack,
+                                  std::string_view name) {
+  Gfx::CheckInit(__func__);
+
+  const PixelView pixels = pack.Find(name);
+  CHECK_NE(pixels.pixels, static_cast<Color32*>(nullptr))
+      << "No image " << name << " in resource pack.";
+
+  if (Gfx::is_software()) {
+    return unique_ptr<Image>(
+        new Image(vector<Color32>(pixels.pixels,
+                                  pixels.pixels + pixels.w * pixels.h),
+                  pixels.w, pixels.h, false));
+  }
+  return unique_ptr<Image>(new Image(
+      UploadTexture(pixels.pixels, pixels.w, pixels.h), pixels.w, pixels.h,
+      false));
+}
+
+deleter_ptr<SDL_Texture> Image::UploadTexture(const Color32* pixels, int w,
+                                              int h) {
+  deleter_ptr<SDL_Texture> texture(
+      SDL_CreateTexture(Gfx::renderer_.get(), SDL_PIXELFORMAT_RGBA8888,
+                        SDL_TEXTUREACCESS_STATIC, w, h),
+      [](SDL_Texture* t) { SDL_DestroyTexture(t); });
+  CHECK_NE(texture.get(), static_cast<SDL_Texture*>(NULL))
+      << "SDL error (SDL_CreateTexture): " << SDL_GetError();
+  CHECK_EQ(SDL_UpdateTexture(texture.get(), nullptr, pixels,
+                             w * sizeof(Color32)),
+           0)
+      << "SDL error (SDL_UpdateTexture): " << SDL_GetError();
+  return texture;
+}
+
 unique_ptr<Image> Image::FromFile(const string& filename) {
   Gfx::CheckInit(__func__);
 
+  if (Gfx::is_software()) return FromPixels(DecodeFile(filename));
+
   int w;
   int h;
   int orig_format_unused;
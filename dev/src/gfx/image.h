@@ -2,7 +2,10 @@
 #define LAND15_GFX_IMAGE_H_
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "common/deleter_ptr.h"
 #include "gfx/core.h"
@@ -14,9 +17,11 @@ namespace land15 {
 namespace gfx {
 
 class Gfx;
+class ResourcePack;
 
 // Fixed size 32bit image class, basically a wrapper around SDL_Texture and an
-// image loading library.
+// image loading library. Under the software backend of Gfx, the image is
+// instead held in system memory.
 class Image {
   friend class Gfx;
 
@@ -24,35 +29,102 @@ class Image {
   Image(const Image&) = delete;
   Image& operator=(const Image&) = delete;
 
-  virtual ~Image() {}
+  virtual ~Image();
 
   // Load an image from a file.
   static std::unique_ptr<Image> FromFile(const std::string& filename);
 
+  // Create an image from pixels in system memory.
+  static std::unique_ptr<Image> FromPixels(PixelBuffer pixels);
+
+  // Create an image from an entry of a resource pack, uploading straight from
+  // the mapped file. Under the software backend the pixels are copied.
+  static std::unique_ptr<Image> FromPack(const ResourcePack& pack,
+                                         std::string_view name);
+
+  // Decodes an image file into system memory. Unlike the other factories, this
+  // doesn't need Gfx and is safe to call from any thread.
+  static PixelBuffer DecodeFile(const std::string& filename);
+
   // Create an image of the provided dimensions. The contents of the texture
   // are undefined and should be cleared/filled-entirely before use.
   static std::unique_ptr<Image> OfSize(glm::ivec2 dimensions);
 
+  // Create an image of the provided dimensions whose pixels are written
+  // directly, between Lock() and Unlock(), rather than drawn to. It starts out
+  // transparent black, and can't be the target of drawing operations.
+  static std::unique_ptr<Image> Streaming(glm::ivec2 dimensions);
+
+  // Gives access to the pixels of a streaming image, all of them or the
+  // region from `a` to `b` (inclusive), the view starting at `a`. The pixels
+  // keep their contents, so can be read as well as written. The image must
+  // not be drawn while locked.
+  PixelView Lock();
+  PixelView Lock(glm::ivec2 a, glm::ivec2 b);
+  // Uploads the locked region to the texture in one update.
+  void Unlock();
+
   int width() const { return w_; }
   int height() const { return h_; }
   bool is_render_target() const { return is_target_; }
+  bool is_streaming() const { return is_streaming_; }
+  bool is_locked() const { return locked_; }
 
  private:
   typedef unsigned char StbImageData;
   Image(common::deleter_ptr<SDL_Texture> texture, int w, int h, bool is_target);
+  Image(std::vector<Color32> pixels, int w, int h, bool is_target);
+  // A streaming image, `texture` being null under the software backend.
+  Image(common::deleter_ptr<SDL_Texture> texture, std::vector<Color32> pixels,
+        int w, int h);
 
   static common::deleter_ptr<SDL_Texture> TextureFromSurface(
       SDL_Surface* surface);
+  // Creates a static texture holding `pixels`, tightly packed.
+  static common::deleter_ptr<SDL_Texture> UploadTexture(const Color32* pixels,
+                                                         int w, int h);
 
   void CheckTarget(std::string_view meth_name) const {
     CHECK(is_target_) << "Image cannot be the target of drawing operation "
                       << meth_name << ".";
   }
 
+  PixelView pixel_view() const { return {pixels_.data(), w_, h_, w_}; }
+
+  // Exactly one of texture_ and pixels_ is used, depending on the Gfx backend,
+  // except for streaming images which keep their pixels in system memory for
+  // Lock() under either. Like the contents of the texture, pixels_ is drawn to
+  // through const Images.
   const common::deleter_ptr<SDL_Texture> texture_;
+  mutable std::vector<Color32> pixels_;
   const int w_;
   const int h_;
   const bool is_target_;
+  const bool is_streaming_ = false;
+
+  // The region given by the last Lock(), inclusive.
+  bool locked_ = false;
+  glm::ivec2 lock_a_{0, 0};
+  glm::ivec2 lock_b_{0, 0};
+
+  // Shadow of the texture state last set through Gfx, empty when unknown.
+  struct TextureState {
+    std::optional<SDL_BlendMode> blend;
+    std::optional<int32_t> color_mod;
+    std::optional<uint8_t> alpha_mod;
+  };
+  mutable TextureState texture_state_;
+};
+
+// A region of an image, such as a sprite within an atlas page, usable with
+// Gfx::Put/PutEx. The corners are inclusive, like src_a/src_b.
+struct SubImage {
+  const Image* image;
+  glm::ivec2 a;
+  glm::ivec2 b;
+
+  int width() const { return b.x - a.x + 1; }
+  int height() const { return b.y - a.y + 1; }
 };
 
 }  // namespace gfx
@@ -0,0 +1,49 @@
+#include "gfx/image_cache.h"
+
+#include <stddef.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "gfx/image.h"
+
+namespace land15 {
+namespace gfx {
+
+using std::shared_ptr;
+using std::weak_ptr;
+
+ImageCache::ImageCache() : state_(std::make_shared<State>()) {}
+
+shared_ptr<const Image> ImageCache::Load(const std::string& filename) {
+  const std::string path =
+      std::filesystem::weakly_canonical(filename).generic_string();
+  weak_ptr<const Image>& entry = state_->images[path];
+  if (shared_ptr<const Image> image = entry.lock()) {
+    ++state_->stats.hits;
+    return image;
+  }
+  ++state_->stats.misses;
+
+  std::unique_ptr<Image> loaded = Image::FromFile(filename);
+  const size_t bytes = size_t{4} * loaded->width() * loaded->height();
+  ++state_->stats.resident_images;
+  state_->stats.resident_bytes += bytes;
+
+  const weak_ptr<State> weak_state = state_;
+  shared_ptr<const Image> image(
+      loaded.release(), [weak_state, path, bytes](const Image* image) {
+        if (shared_ptr<State> state = weak_state.lock()) {
+          state->images.erase(path);
+          --state->stats.resident_images;
+          state->stats.resident_bytes -= bytes;
+        }
+        delete image;
+      });
+  entry = image;
+  return image;
+}
+
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,55 @@
+#ifndef LAND15_GFX_IMAGE_CACHE_H_
+#define LAND15_GFX_IMAGE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "gfx/image.h"
+
+namespace land15 {
+namespace gfx {
+
+// Deduplicates image loads by canonical path. Every request for a file that's
+// already loaded shares the same Image, which is freed when the last handle to
+// it is released. Only to be used from the render thread.
+class ImageCache {
+ public:
+  ImageCache(const ImageCache&) = delete;
+  ImageCache& operator=(const ImageCache&) = delete;
+
+  ImageCache();
+
+  // Returns the image in `filename`, loading it with Image::FromFile unless
+  // it's already resident. Handles may outlive the cache.
+  std::shared_ptr<const Image> Load(const std::string& filename);
+
+  struct Stats {
+    // Requests served by an image that was already resident, each one a
+    // duplicate load avoided.
+    uint64_t hits = 0;
+    // Requests that had to load the file.
+    uint64_t misses = 0;
+    int resident_images = 0;
+    // Counted as 4 bytes per pixel.
+    size_t resident_bytes = 0;
+  };
+  const Stats& stats() const { return state_->stats; }
+
+ private:
+  // Shared with the deleters of the handles given out, so they can outlive
+  // the cache.
+  struct State {
+    std::unordered_map<std::string, std::weak_ptr<const Image>> images;
+    Stats stats;
+  };
+  const std::shared_ptr<State> state_;
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_IMAGE_CACHE_H_
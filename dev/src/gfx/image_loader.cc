@@ -0,0 +1,101 @@
+#include "gfx/image_loader.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "gfx/core.h"
+#include "gfx/image.h"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace gfx {
+
+using std::shared_ptr;
+
+ImageLoader::ImageLoader(int threads) {
+  if (threads == 0) {
+    threads = std::max<int>(std::thread::hardware_concurrency() - 1, 1);
+  }
+  CHECK_GT(threads, 0) << "ImageLoader needs at least one thread.";
+  for (int i = 0; i < threads; ++i) workers_.emplace_back([this] { Work(); });
+}
+
+ImageLoader::~ImageLoader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+shared_ptr<PendingImage> ImageLoader::Load(std::string filename) {
+  shared_ptr<PendingImage> pending(new PendingImage(std::move(filename)));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    to_decode_.push_back(pending);
+  }
+  work_cv_.notify_one();
+  return pending;
+}
+
+void ImageLoader::Work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this] { return stopping_ || !to_decode_.empty(); });
+    if (stopping_) return;
+    shared_ptr<PendingImage> pending = std::move(to_decode_.front());
+    to_decode_.pop_front();
+    ++decoding_;
+
+    lock.unlock();
+    PixelBuffer pixels = Image::DecodeFile(pending->filename());
+    lock.lock();
+
+    pending->pixels_ = std::move(pixels);
+    to_upload_.push_back(std::move(pending));
+    --decoding_;
+    decoded_cv_.notify_all();
+  }
+}
+
+int ImageLoader::Upload(size_t budget_bytes) {
+  int uploaded = 0;
+  size_t bytes = 0;
+  while (bytes < budget_bytes) {
+    shared_ptr<PendingImage> pending;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (to_upload_.empty()) break;
+      pending = std::move(to_upload_.front());
+      to_upload_.pop_front();
+    }
+    bytes += pending->pixels_.pixels.size() * sizeof(Color32);
+    pending->image_ = Image::FromPixels(std::move(pending->pixels_));
+    ++uploaded;
+  }
+  return uploaded;
+}
+
+void ImageLoader::Finish() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    decoded_cv_.wait(lock,
+                     [this] { return to_decode_.empty() && (decoding_ == 0); });
+  }
+  Upload(static_cast<size_t>(-1));
+}
+
+bool ImageLoader::idle() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return to_decode_.empty() && (decoding_ == 0) && to_upload_.empty();
+}
+
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,106 @@
+#ifndef LAND15_GFX_IMAGE_LOADER_H_
+#define LAND15_GFX_IMAGE_LOADER_H_
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gfx/core.h"
+#include "gfx/image.h"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace gfx {
+
+class ImageLoader;
+
+// An image being loaded by an ImageLoader. Only to be used from the render
+// thread.
+class PendingImage {
+ public:
+  PendingImage(const PendingImage&) = delete;
+  PendingImage& operator=(const PendingImage&) = delete;
+
+  // True once the image has been uploaded.
+  bool ready() const { return image_ != nullptr; }
+
+  const Image& image() const {
+    CHECK(ready()) << "Image " << filename_ << " isn't loaded yet.";
+    return *image_;
+  }
+
+  // Takes ownership of the loaded image.
+  std::unique_ptr<Image> Release() {
+    CHECK(ready()) << "Image " << filename_ << " isn't loaded yet.";
+    return std::move(image_);
+  }
+
+  const std::string& filename() const { return filename_; }
+
+ private:
+  friend class ImageLoader;
+  explicit PendingImage(std::string filename)
+      : filename_(std::move(filename)) {}
+
+  const std::string filename_;
+  // Written by a worker, then read by the render thread under the loader's
+  // lock.
+  PixelBuffer pixels_;
+  std::unique_ptr<Image> image_;
+};
+
+// Loads images asynchronously: files are decoded on a pool of worker threads,
+// and the decoded pixels are uploaded on the render thread by Upload(), a
+// bounded amount at a time so that loading never stalls a frame for long.
+//
+// Gfx must stay initialized for the lifetime of the loader.
+class ImageLoader {
+ public:
+  ImageLoader(const ImageLoader&) = delete;
+  ImageLoader& operator=(const ImageLoader&) = delete;
+
+  // Starts `threads` decoding threads, or one less than the number of cores if
+  // zero.
+  explicit ImageLoader(int threads = 0);
+  ~ImageLoader();
+
+  // Queues an image file to be loaded.
+  std::shared_ptr<PendingImage> Load(std::string filename);
+
+  // Uploads decoded images until at least `budget_bytes` of pixels have been
+  // uploaded or none are left. Must be called from the render thread,
+  // typically once per frame. Returns the number of images uploaded.
+  int Upload(size_t budget_bytes);
+
+  // Waits for every queued image to be decoded, and uploads them all.
+  void Finish();
+
+  // True if no images are waiting to be decoded or uploaded.
+  bool idle() const;
+
+ private:
+  void Work();
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable decoded_cv_;
+  bool stopping_ = false;
+  std::deque<std::shared_ptr<PendingImage>> to_decode_;
+  std::deque<std::shared_ptr<PendingImage>> to_upload_;
+  // Images being decoded right now.
+  int decoding_ = 0;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_IMAGE_LOADER_H_
@@ -0,0 +1,83 @@
+#include "gfx/input.h"
+
+#include <stdint.h>
+
+#include "glm/vec2.hpp"
+#include "SDL.h"
+
+namespace land15 {
+namespace gfx {
+
+uint64_t Input::NowNs() { return SDL_GetTicksNS(); }
+
+bool Input::Next(uint64_t& cursor, uint64_t until_ns,
+                 InputEvent& event) const {
+  if (count_ - cursor > kCapacity) cursor = count_ - kCapacity;
+  if (cursor == count_) return false;
+  const InputEvent& next = events_[cursor % kCapacity];
+  if (next.time_ns > until_ns) return false;
+  event = next;
+  ++cursor;
+  return true;
+}
+
+void Input::BeginFrame() {
+  keys_pressed_.reset();
+  keys_released_.reset();
+  buttons_pressed_.reset();
+  buttons_released_.reset();
+}
+
+void Input::Push(const InputEvent& event) {
+  events_[count_ % kCapacity] = event;
+  ++count_;
+}
+
+void Input::Record(const SDL_Event& event) {
+  const uint64_t time_ns = event.common.timestamp;
+  switch (event.type) {
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP: {
+      const int key = event.key.keysym.scancode;
+      if ((key < 0) || (key >= kNumKeys)) return;
+      const bool down = event.type == SDL_EVENT_KEY_DOWN;
+      if (down && !event.key.repeat) keys_pressed_[key] = true;
+      if (!down) keys_released_[key] = true;
+      keys_down_[key] = down;
+      Push({down ? InputEvent::kKeyDown : InputEvent::kKeyUp, time_ns, key,
+            event.key.repeat != 0, mouse_position_});
+      return;
+    }
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP: {
+      const int button = event.button.button;
+      if (button >= kNumButtons) return;
+      const bool down = event.type == SDL_EVENT_MOUSE_BUTTON_DOWN;
+      if (down) {
+        buttons_pressed_[button] = true;
+      } else {
+        buttons_released_[button] = true;
+      }
+      buttons_down_[button] = down;
+      mouse_position_ = {event.button.x, event.button.y};
+      Push({down ? InputEvent::kMouseDown : InputEvent::kMouseUp, time_ns,
+            button, false, mouse_position_});
+      return;
+    }
+    case SDL_EVENT_MOUSE_MOTION:
+      mouse_position_ = {event.motion.x, event.motion.y};
+      Push({InputEvent::kMouseMotion, time_ns, 0, false, mouse_position_});
+      return;
+    case SDL_EVENT_MOUSE_WHEEL:
+      mouse_wheel_ += glm::vec2(event.wheel.x, event.wheel.y);
+      Push({InputEvent::kMouseWheel, time_ns, 0, false,
+            {event.wheel.x, event.wheel.y}});
+      return;
+    case SDL_EVENT_QUIT:
+      Push({InputEvent::kQuit, time_ns, 0, false, mouse_position_});
+      return;
+  }
+}
+
+}  // namespace gfx
+}  // namespace land15
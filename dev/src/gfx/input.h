@@ -0,0 +1,111 @@
+#ifndef LAND15_GFX_INPUT_H_
+#define LAND15_GFX_INPUT_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <bitset>
+
+#include "glm/vec2.hpp"
+#include "SDL.h"
+
+namespace land15 {
+namespace gfx {
+
+// A keyboard or mouse event, stamped with the time SDL received it.
+struct InputEvent {
+  enum Type {
+    kKeyDown = 0,
+    kKeyUp = 1,
+    kMouseDown = 2,
+    kMouseUp = 3,
+    kMouseMotion = 4,
+    kMouseWheel = 5,
+    kQuit = 6
+  };
+  Type type;
+  // On the clock of Input::NowNs().
+  uint64_t time_ns;
+  // The SDL_Scancode of key events, or the SDL button of mouse button events.
+  int code;
+  // Key events repeated by holding the key down.
+  bool repeat;
+  // The pointer position of mouse events, or the scroll of wheel events.
+  glm::vec2 value;
+};
+
+// Every input event received, in order, in a fixed ring buffer, along with the
+// state of every key and mouse button and which of them went down or up since
+// the previous frame. Fed by Gfx::SyncInputs(), once per frame.
+//
+// Events are numbered in the order received, so a consumer can keep a cursor
+// into the stream and take events up to a point in time, like the end of a
+// simulation tick, rather than a frame at a time.
+class Input {
+ public:
+  static constexpr int kCapacity = 1024;
+  static constexpr int kNumKeys = SDL_NUM_SCANCODES;
+  static constexpr int kNumButtons = 8;
+
+  // The time on the clock events are stamped with.
+  static uint64_t NowNs();
+
+  // Takes the next event stamped at or before `until_ns` from `cursor`,
+  // advancing it. Returns false if there's none yet. Events overwritten
+  // before being taken are skipped.
+  bool Next(uint64_t& cursor, uint64_t until_ns, InputEvent& event) const;
+
+  // Sequence number of the next event to be received, to start a cursor from
+  // events yet to come.
+  uint64_t end() const { return count_; }
+
+  bool IsKeyDown(SDL_Scancode key) const { return keys_down_[key]; }
+  // Keys pressed and released since the previous frame. A key tapped within a
+  // frame is in both.
+  bool WasKeyPressed(SDL_Scancode key) const { return keys_pressed_[key]; }
+  bool WasKeyReleased(SDL_Scancode key) const { return keys_released_[key]; }
+  const std::bitset<kNumKeys>& keys_down() const { return keys_down_; }
+  const std::bitset<kNumKeys>& keys_pressed() const { return keys_pressed_; }
+  const std::bitset<kNumKeys>& keys_released() const {
+    return keys_released_;
+  }
+
+  // By SDL button number.
+  bool IsButtonDown(int button) const { return buttons_down_[button]; }
+  bool WasButtonPressed(int button) const { return buttons_pressed_[button]; }
+  bool WasButtonReleased(int button) const {
+    return buttons_released_[button];
+  }
+
+  glm::vec2 mouse_position() const { return mouse_position_; }
+  // Total scroll since the start.
+  glm::vec2 mouse_wheel() const { return mouse_wheel_; }
+
+ private:
+  friend class Gfx;
+  friend class InputTest;
+
+  // Clears the edges of the previous frame.
+  void BeginFrame();
+  // Records an SDL event, ignoring the ones that aren't input.
+  void Record(const SDL_Event& event);
+  void Push(const InputEvent& event);
+
+  std::array<InputEvent, kCapacity> events_;
+  // Events received so far.
+  uint64_t count_ = 0;
+
+  std::bitset<kNumKeys> keys_down_;
+  std::bitset<kNumKeys> keys_pressed_;
+  std::bitset<kNumKeys> keys_released_;
+  std::bitset<kNumButtons> buttons_down_;
+  std::bitset<kNumButtons> buttons_pressed_;
+  std::bitset<kNumButtons> buttons_released_;
+  glm::vec2 mouse_position_{0, 0};
+  glm::vec2 mouse_wheel_{0, 0};
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_INPUT_H_
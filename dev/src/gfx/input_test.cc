@@ -0,0 +1,147 @@
+#include "gfx/input.h"
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+#include "SDL.h"
+
+namespace land15 {
+namespace gfx {
+
+class InputTest : public testing::Test {
+ protected:
+  void BeginFrame() { input_.BeginFrame(); }
+
+  void Key(bool down, SDL_Scancode key, uint64_t time_ns,
+           bool repeat = false) {
+    SDL_Event event{};
+    event.key.type = down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+    event.key.timestamp = time_ns;
+    event.key.repeat = repeat;
+    event.key.keysym.scancode = key;
+    input_.Record(event);
+  }
+
+  void Wheel(float y, uint64_t time_ns) {
+    SDL_Event event{};
+    event.wheel.type = SDL_EVENT_MOUSE_WHEEL;
+    event.wheel.timestamp = time_ns;
+    event.wheel.y = y;
+    input_.Record(event);
+  }
+
+  Input input_;
+};
+
+namespace {
+
+TEST_F(InputTest, KeyEdges) {
+  BeginFrame();
+  Key(true, SDL_SCANCODE_A, 10);
+  EXPECT_TRUE(input_.IsKeyDown(SDL_SCANCODE_A));
+  EXPECT_TRUE(input_.WasKeyPressed(SDL_SCANCODE_A));
+  EXPECT_FALSE(input_.WasKeyReleased(SDL_SCANCODE_A));
+
+  // Held over the next frame: down, but no new edge.
+  BeginFrame();
+  EXPECT_TRUE(input_.IsKeyDown(SDL_SCANCODE_A));
+  EXPECT_FALSE(input_.WasKeyPressed(SDL_SCANCODE_A));
+
+  BeginFrame();
+  Key(false, SDL_SCANCODE_A, 20);
+  EXPECT_FALSE(input_.IsKeyDown(SDL_SCANCODE_A));
+  EXPECT_FALSE(input_.WasKeyPressed(SDL_SCANCODE_A));
+  EXPECT_TRUE(input_.WasKeyReleased(SDL_SCANCODE_A));
+}
+
+TEST_F(InputTest, TapWithinAFrameIsKept) {
+  BeginFrame();
+  Key(true, SDL_SCANCODE_SPACE, 10);
+  Key(false, SDL_SCANCODE_SPACE, 11);
+  EXPECT_FALSE(input_.IsKeyDown(SDL_SCANCODE_SPACE));
+  EXPECT_TRUE(input_.WasKeyPressed(SDL_SCANCODE_SPACE));
+  EXPECT_TRUE(input_.WasKeyReleased(SDL_SCANCODE_SPACE));
+
+  BeginFrame();
+  EXPECT_FALSE(input_.WasKeyPressed(SDL_SCANCODE_SPACE));
+  EXPECT_FALSE(input_.WasKeyReleased(SDL_SCANCODE_SPACE));
+}
+
+TEST_F(InputTest, RepeatsAreRecordedButAreNotPresses) {
+  BeginFrame();
+  Key(true, SDL_SCANCODE_A, 10);
+  BeginFrame();
+  Key(true, SDL_SCANCODE_A, 20, /*repeat=*/true);
+  EXPECT_TRUE(input_.IsKeyDown(SDL_SCANCODE_A));
+  EXPECT_FALSE(input_.WasKeyPressed(SDL_SCANCODE_A));
+
+  uint64_t cursor = 0;
+  InputEvent event;
+  ASSERT_TRUE(input_.Next(cursor, 100, event));
+  EXPECT_FALSE(event.repeat);
+  ASSERT_TRUE(input_.Next(cursor, 100, event));
+  EXPECT_EQ(event.type, InputEvent::kKeyDown);
+  EXPECT_EQ(event.code, SDL_SCANCODE_A);
+  EXPECT_TRUE(event.repeat);
+  EXPECT_FALSE(input_.Next(cursor, 100, event));
+}
+
+TEST_F(InputTest, NextStopsAtTime) {
+  Key(true, SDL_SCANCODE_UP, 10);
+  Wheel(2, 20);
+  Key(false, SDL_SCANCODE_UP, 30);
+
+  uint64_t cursor = 0;
+  InputEvent event;
+  ASSERT_TRUE(input_.Next(cursor, 20, event));
+  EXPECT_EQ(event.time_ns, 10);
+  ASSERT_TRUE(input_.Next(cursor, 20, event));
+  EXPECT_EQ(event.type, InputEvent::kMouseWheel);
+  EXPECT_EQ(event.value.y, 2);
+  EXPECT_FALSE(input_.Next(cursor, 29, event));
+  EXPECT_EQ(cursor, 2);
+
+  ASSERT_TRUE(input_.Next(cursor, 30, event));
+  EXPECT_EQ(event.type, InputEvent::kKeyUp);
+  EXPECT_FALSE(input_.Next(cursor, 1000, event));
+  EXPECT_EQ(cursor, input_.end());
+}
+
+TEST_F(InputTest, CursorSkipsOverwrittenEvents) {
+  constexpr int kOverflow = 10;
+  for (int i = 0; i < Input::kCapacity + kOverflow; ++i) Wheel(1, i);
+  ASSERT_EQ(input_.end(), Input::kCapacity + kOverflow);
+
+  // The oldest events were overwritten, so the cursor jumps to the oldest one
+  // still held.
+  uint64_t cursor = 0;
+  InputEvent event;
+  ASSERT_TRUE(input_.Next(cursor, UINT64_MAX, event));
+  EXPECT_EQ(event.time_ns, kOverflow);
+  EXPECT_EQ(cursor, kOverflow + 1);
+
+  int taken = 1;
+  uint64_t last_ns = event.time_ns;
+  while (input_.Next(cursor, UINT64_MAX, event)) {
+    EXPECT_EQ(event.time_ns, last_ns + 1);
+    last_ns = event.time_ns;
+    ++taken;
+  }
+  EXPECT_EQ(taken, Input::kCapacity);
+
+  // A cursor overtaken while partway through also skips ahead.
+  cursor = input_.end() - 5;
+  for (int i = 0; i < Input::kCapacity; ++i) Wheel(1, 5000 + i);
+  ASSERT_TRUE(input_.Next(cursor, UINT64_MAX, event));
+  EXPECT_EQ(event.time_ns, 5000);
+}
+
+TEST_F(InputTest, WheelAccumulates) {
+  Wheel(1, 10);
+  Wheel(-3, 20);
+  EXPECT_EQ(input_.mouse_wheel().y, -2);
+}
+
+}  // namespace
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,126 @@
+#include "gfx/pack.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/mapped_file.h"
+#include "gfx/core.h"
+#include "glog/logging.h"
+
+namespace land15 {
+namespace gfx {
+
+using std::string_view;
+
+namespace {
+
+uint64_t Align(uint64_t offset) {
+  return (offset + kPackAlignment - 1) / kPackAlignment * kPackAlignment;
+}
+
+}  // namespace
+
+void WritePack(const std::string& filename,
+               const std::vector<std::pair<std::string, PixelBuffer>>& images) {
+  std::vector<int> order(images.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&images](int l, int r) {
+    return images[l].first < images[r].first;
+  });
+
+  PackHeader header{};
+  memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+  header.version = kPackVersion;
+  header.entry_count = images.size();
+
+  std::vector<PackEntry> entries(images.size());
+  uint64_t offset =
+      Align(sizeof(PackHeader) + sizeof(PackEntry) * images.size());
+  for (int i = 0; i < order.size(); ++i) {
+    const auto& [name, pixels] = images[order[i]];
+    CHECK_LE(name.size(), kPackMaxNameLength)
+        << "Pack entry name too long: " << name;
+    CHECK(i == 0 || name != images[order[i - 1]].first)
+        << "Duplicate pack entry: " << name;
+    PackEntry& entry = entries[i];
+    memset(entry.name, 0, sizeof(entry.name));
+    memcpy(entry.name, name.data(), name.size());
+    entry.w = pixels.w;
+    entry.h = pixels.h;
+    entry.offset = offset;
+    offset = Align(offset + pixels.pixels.size() * sizeof(Color32));
+  }
+
+  std::ofstream out(filename, std::ios::binary);
+  CHECK(out) << "Couldn't open " << filename << " for writing.";
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(entries.data()),
+            sizeof(PackEntry) * entries.size());
+  for (int i = 0; i < order.size(); ++i) {
+    const PixelBuffer& pixels = images[order[i]].second;
+    // Pad up to the payload.
+    const std::string padding(entries[i].offset - out.tellp(), '\0');
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char*>(pixels.pixels.data()),
+              pixels.pixels.size() * sizeof(Color32));
+  }
+  CHECK(out) << "Error writing " << filename;
+}
+
+ResourcePack::ResourcePack(std::unique_ptr<common::MappedFile> file)
+    : file_(std::move(file)),
+      header_(reinterpret_cast<const PackHeader*>(file_->data())),
+      entries_(reinterpret_cast<const PackEntry*>(file_->data() +
+                                                  sizeof(PackHeader))) {}
+
+std::unique_ptr<ResourcePack> ResourcePack::Open(const std::string& filename) {
+  std::unique_ptr<common::MappedFile> file = common::MappedFile::Open(filename);
+  CHECK_GE(file->size(), sizeof(PackHeader)) << filename << " isn't a pack.";
+  std::unique_ptr<ResourcePack> pack(new ResourcePack(std::move(file)));
+
+  const PackHeader& header = *pack->header_;
+  CHECK_EQ(memcmp(header.magic, kPackMagic, sizeof(kPackMagic)), 0)
+      << filename << " isn't a pack.";
+  CHECK_EQ(header.version, kPackVersion)
+      << filename << " has an unsupported pack version.";
+  const size_t file_size = pack->file_->size();
+  CHECK_LE(sizeof(PackHeader) + sizeof(PackEntry) * header.entry_count,
+           file_size)
+      << filename << " is truncated.";
+  for (int i = 0; i < pack->size(); ++i) {
+    const PackEntry& entry = pack->entry(i);
+    CHECK_EQ(entry.name[kPackMaxNameLength], '\0')
+        << filename << " is corrupt.";
+    CHECK_LE(entry.offset + uint64_t{entry.w} * entry.h * sizeof(Color32),
+             file_size)
+        << filename << " is truncated.";
+  }
+  return pack;
+}
+
+PixelView ResourcePack::Find(string_view name) const {
+  const PackEntry* end = entries_ + size();
+  const PackEntry* found =
+      std::lower_bound(entries_, end, name,
+                       [](const PackEntry& entry, string_view name) {
+                         return entry.name < name;
+                       });
+  if ((found == end) || (found->name != name)) return {nullptr, 0, 0, 0};
+  // The mapping is read-only, but PixelView is shared with writable buffers.
+  Color32* pixels = reinterpret_cast<Color32*>(
+      const_cast<uint8_t*>(file_->data() + found->offset));
+  const int w = found->w;
+  const int h = found->h;
+  return {pixels, w, h, w};
+}
+
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,86 @@
+#ifndef LAND15_GFX_PACK_H_
+#define LAND15_GFX_PACK_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/mapped_file.h"
+#include "gfx/core.h"
+
+// A resource pack is a single file holding pre-decoded images, so they can be
+// memory mapped and uploaded without decoding or converting anything. Packs
+// are baked from a directory of images by the land15_bake tool.
+//
+// Layout (all little endian):
+//
+//   PackHeader
+//   PackEntry[entry_count], sorted by name
+//   pixel payloads, each kPackAlignment aligned
+//
+// Payloads are tightly packed rows of Color32, which is the same layout as
+// SDL_PIXELFORMAT_RGBA8888 used for every texture Gfx creates.
+
+namespace land15 {
+namespace gfx {
+
+constexpr char kPackMagic[4] = {'L', '1', '5', 'P'};
+constexpr uint32_t kPackVersion = 1;
+constexpr int kPackAlignment = 64;
+constexpr int kPackMaxNameLength = 47;
+
+struct PackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+};
+static_assert(sizeof(PackHeader) == 16);
+
+struct PackEntry {
+  // Null terminated.
+  char name[kPackMaxNameLength + 1];
+  uint32_t w;
+  uint32_t h;
+  // From the start of the file.
+  uint64_t offset;
+};
+static_assert(sizeof(PackEntry) == 64);
+
+// Writes a pack holding `images`, each paired with the name it's looked up
+// by.
+void WritePack(const std::string& filename,
+               const std::vector<std::pair<std::string, PixelBuffer>>& images);
+
+// A memory mapped pack.
+class ResourcePack {
+ public:
+  ResourcePack(const ResourcePack&) = delete;
+  ResourcePack& operator=(const ResourcePack&) = delete;
+
+  // Maps and validates the pack at `filename`.
+  static std::unique_ptr<ResourcePack> Open(const std::string& filename);
+
+  // Returns the pixels of the image called `name` straight from the mapping,
+  // or a view with null pixels if there isn't one.
+  PixelView Find(std::string_view name) const;
+
+  int size() const { return header_->entry_count; }
+  const PackEntry& entry(int i) const { return entries_[i]; }
+
+ private:
+  explicit ResourcePack(std::unique_ptr<common::MappedFile> file);
+
+  const std::unique_ptr<common::MappedFile> file_;
+  const PackHeader* header_;
+  const PackEntry* entries_;
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_PACK_H_
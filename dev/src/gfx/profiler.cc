@@ -0,0 +1,180 @@
+#include "gfx/profiler.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace land15 {
+namespace gfx {
+
+namespace {
+
+constexpr const char* kSectionNames[kNumProfileSections] = {
+    "other",    "cls",      "pset",  "line", "rect",    "fillrect", "put",
+    "textline", "textpara", "flush", "flip", "present", "overlay"};
+
+constexpr const char* kCounterNames[kNumProfileCounters] = {
+    "ops",    "submits", "binds",  "targets",
+    "states", "elided",  "pixels", "updated"};
+
+// Formats a count in 7 characters.
+std::string FormatCount(double n) {
+  char buffer[16];
+  if (n < 1e6) {
+    snprintf(buffer, sizeof(buffer), "%7.0f", n);
+  } else {
+    snprintf(buffer, sizeof(buffer), "%6.1fM", n * 1e-6);
+  }
+  return buffer;
+}
+
+std::string FormatRow(const char* name, const std::string& a,
+                      const std::string& b, const std::string& c,
+                      const std::string& d) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%-8s%7s%7s%7s%7s", name, a.c_str(),
+           b.c_str(), c.c_str(), d.c_str());
+  return buffer;
+}
+
+std::string FormatMillis(double ms) {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%7.2f", ms);
+  return buffer;
+}
+
+}  // namespace
+
+const char* ProfileSectionName(ProfileSection section) {
+  CHECK((section >= 0) && (section < kNumProfileSections))
+      << "Not a real profile section: " << section;
+  return kSectionNames[section];
+}
+
+const char* ProfileCounterName(ProfileCounter counter) {
+  CHECK((counter >= 0) && (counter < kNumProfileCounters))
+      << "Not a real profile counter: " << counter;
+  return kCounterNames[counter];
+}
+
+uint64_t FrameProfile::frame_nanos() const {
+  uint64_t total = 0;
+  for (const uint64_t n : nanos) total += n;
+  return total;
+}
+
+Profiler::Profiler(int window) : section_start_(Clock::now()) {
+  SetWindow(window);
+}
+
+void Profiler::Charge() {
+  const Clock::time_point now = Clock::now();
+  frame_.nanos[section_] +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now -
+                                                           section_start_)
+          .count();
+  section_start_ = now;
+}
+
+ProfileSection Profiler::Enter(ProfileSection section) {
+  Charge();
+  ++frame_.calls[section];
+  const ProfileSection parent = section_;
+  section_ = section;
+  return parent;
+}
+
+void Profiler::Exit(ProfileSection parent) {
+  Charge();
+  section_ = parent;
+}
+
+void Profiler::EndFrame() {
+  Charge();
+  last_frame_ = frame_;
+  history_[history_next_] = frame_;
+  history_next_ = (history_next_ + 1) % history_.size();
+  history_size_ = std::min<int>(history_size_ + 1, history_.size());
+  frame_ = FrameProfile();
+}
+
+void Profiler::SetWindow(int window) {
+  CHECK_GT(window, 0) << "Profile window must hold at least one frame.";
+  history_.assign(window, FrameProfile());
+  history_next_ = 0;
+  history_size_ = 0;
+}
+
+template <class F>
+RollingStat Profiler::Stat(F value) const {
+  if (history_size_ == 0) return RollingStat();
+  std::vector<double> values;
+  values.reserve(history_size_);
+  for (int i = 0; i < history_size_; ++i) values.push_back(value(history_[i]));
+  std::sort(values.begin(), values.end());
+
+  RollingStat stat;
+  stat.min = values.front();
+  for (const double v : values) stat.avg += v;
+  stat.avg /= values.size();
+  stat.p99 = values[static_cast<int>(std::ceil(0.99 * values.size())) - 1];
+  return stat;
+}
+
+RollingStat Profiler::FrameTimeStat() const {
+  return Stat([](const FrameProfile& f) { return f.frame_nanos() * 1e-6; });
+}
+
+RollingStat Profiler::TimeStat(ProfileSection section) const {
+  return Stat(
+      [section](const FrameProfile& f) { return f.nanos[section] * 1e-6; });
+}
+
+RollingStat Profiler::CallsStat(ProfileSection section) const {
+  return Stat([section](const FrameProfile& f) {
+    return static_cast<double>(f.calls[section]);
+  });
+}
+
+RollingStat Profiler::CounterStat(ProfileCounter counter) const {
+  return Stat([counter](const FrameProfile& f) {
+    return static_cast<double>(f.counters[counter]);
+  });
+}
+
+std::vector<std::string> Profiler::FormatOverlay() const {
+  std::vector<std::string> lines;
+  lines.push_back(FormatRow("ms", "calls", "min", "avg", "p99"));
+
+  const RollingStat frame = FrameTimeStat();
+  lines.push_back(FormatRow("frame", "", FormatMillis(frame.min),
+                            FormatMillis(frame.avg), FormatMillis(frame.p99)));
+  for (int s = 0; s < kNumProfileSections; ++s) {
+    const auto section = static_cast<ProfileSection>(s);
+    const RollingStat time = TimeStat(section);
+    if (time.p99 == 0) continue;
+    lines.push_back(FormatRow(
+        kSectionNames[s],
+        section == kSectionOther ? "" : FormatCount(CallsStat(section).avg),
+        FormatMillis(time.min), FormatMillis(time.avg),
+        FormatMillis(time.p99)));
+  }
+
+  lines.push_back(FormatRow("count", "", "min", "avg", "p99"));
+  for (int c = 0; c < kNumProfileCounters; ++c) {
+    const RollingStat count = CounterStat(static_cast<ProfileCounter>(c));
+    lines.push_back(FormatRow(kCounterNames[c], "", FormatCount(count.min),
+                              FormatCount(count.avg), FormatCount(count.p99)));
+  }
+  return lines;
+}
+
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,165 @@
+#ifndef LAND15_GFX_PROFILER_H_
+#define LAND15_GFX_PROFILER_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Per-frame counters and timings kept by Gfx, along with rolling statistics
+// over the last few frames. Everything here is a handful of increments and a
+// clock read per Gfx call, so it's always on.
+
+namespace land15 {
+namespace gfx {
+
+// The parts of Gfx whose time is tracked. Time is exclusive: a section
+// entered from inside another (like a flush triggered by a Line() call) is
+// only charged to the inner one.
+enum ProfileSection {
+  // Everything outside of Gfx, like simulation.
+  kSectionOther = 0,
+  kSectionCls,
+  kSectionPSet,
+  kSectionLine,
+  kSectionRect,
+  kSectionFillRect,
+  // Put, PutEx and PutBatch.
+  kSectionPut,
+  kSectionTextLine,
+  kSectionTextParagraph,
+  // Submission of deferred draws.
+  kSectionFlush,
+  // Flip() up until presenting, including the software screen upload.
+  kSectionFlip,
+  // SDL_RenderPresent(), which is where waiting for vsync happens.
+  kSectionPresent,
+  // Drawing the profile overlay itself.
+  kSectionOverlay,
+  kNumProfileSections
+};
+
+const char* ProfileSectionName(ProfileSection section);
+
+enum ProfileCounter {
+  // Put/PutEx calls and glyphs drawn.
+  kCounterDrawOps = 0,
+  // Calls into SDL that draw something.
+  kCounterSubmissions,
+  // Submissions using a different texture than the previous one.
+  kCounterTextureBinds,
+  // Render target changes passed on to SDL.
+  kCounterTargetSwitches,
+  // Renderer/texture state changes passed on to SDL (including target
+  // switches).
+  kCounterStateChanges,
+  // State changes skipped because the value was already set.
+  kCounterStateChangesElided,
+  // Destination pixels covered by drawing calls, before clipping.
+  kCounterPixels,
+  // Screen pixels updated by Flip(), less than the whole screen only with
+  // dirty tracking.
+  kCounterUpdatedPixels,
+  kNumProfileCounters
+};
+
+const char* ProfileCounterName(ProfileCounter counter);
+
+struct FrameProfile {
+  // Number of calls made to each section.
+  uint64_t calls[kNumProfileSections] = {};
+  uint64_t nanos[kNumProfileSections] = {};
+  uint64_t counters[kNumProfileCounters] = {};
+
+  // Total time from the end of the previous Flip() to the end of this one.
+  uint64_t frame_nanos() const;
+};
+
+// The min, average and 99th percentile of a value over a window of frames.
+struct RollingStat {
+  double min = 0;
+  double avg = 0;
+  double p99 = 0;
+};
+
+class Profiler {
+ public:
+  // Keeps statistics over the last `window` frames.
+  explicit Profiler(int window);
+
+  // Charges time to `section` while in scope.
+  class ScopedSection {
+   public:
+    ScopedSection(const ScopedSection&) = delete;
+    ScopedSection& operator=(const ScopedSection&) = delete;
+
+    ScopedSection(Profiler& profiler, ProfileSection section)
+        : profiler_(profiler), parent_(profiler.Enter(section)) {}
+    ~ScopedSection() { profiler_.Exit(parent_); }
+
+   private:
+    Profiler& profiler_;
+    const ProfileSection parent_;
+  };
+
+  void Count(ProfileCounter counter, uint64_t n = 1) {
+    frame_.counters[counter] += n;
+  }
+
+  // Counts a submission drawing from `texture`.
+  void CountSubmission(const void* texture) {
+    ++frame_.counters[kCounterSubmissions];
+    if (texture != bound_texture_) {
+      ++frame_.counters[kCounterTextureBinds];
+      bound_texture_ = texture;
+    }
+  }
+
+  // Closes the current frame, adding it to the window, and starts a new one.
+  void EndFrame();
+
+  // Resizes the window, discarding the frames in it.
+  void SetWindow(int window);
+
+  // The last complete frame.
+  const FrameProfile& last_frame() const { return last_frame_; }
+
+  // Statistics over the frames in the window. Times are in milliseconds and
+  // include the frame time as a whole.
+  RollingStat FrameTimeStat() const;
+  RollingStat TimeStat(ProfileSection section) const;
+  RollingStat CallsStat(ProfileSection section) const;
+  RollingStat CounterStat(ProfileCounter counter) const;
+
+  // Formats a summary of the window in lines of at most 40 characters, for
+  // drawing with the system font.
+  std::vector<std::string> FormatOverlay() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  ProfileSection Enter(ProfileSection section);
+  void Exit(ProfileSection parent);
+  // Charges the time since the last transition to the current section.
+  void Charge();
+
+  template <class F>
+  RollingStat Stat(F value) const;
+
+  FrameProfile frame_;
+  FrameProfile last_frame_;
+  ProfileSection section_ = kSectionOther;
+  Clock::time_point section_start_;
+  const void* bound_texture_ = nullptr;
+
+  // Ring buffer of the last frames.
+  std::vector<FrameProfile> history_;
+  int history_next_ = 0;
+  int history_size_ = 0;
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_PROFILER_H_
@@ -0,0 +1,124 @@
+#include "gfx/raster.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "gfx/blend.h"
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace gfx {
+namespace raster {
+
+using blend::BlendPixel;
+using glm::ivec2;
+
+namespace {
+
+// Clips the `dims` sized rect at `p` to `dst`, returning false if nothing is
+// left.
+bool ClipRect(const PixelView& dst, ivec2& p, ivec2& dims) {
+  const int x0 = std::max(p.x, 0);
+  const int y0 = std::max(p.y, 0);
+  const int x1 = std::min(p.x + dims.x, dst.w);
+  const int y1 = std::min(p.y + dims.y, dst.h);
+  if ((x0 >= x1) || (y0 >= y1)) return false;
+  p = {x0, y0};
+  dims = {x1 - x0, y1 - y0};
+  return true;
+}
+
+inline void HLine(PixelView dst, int x0, int x1, int y, Color32 col) {
+  if ((y < 0) || (y >= dst.h)) return;
+  x0 = std::max(x0, 0);
+  x1 = std::min(x1, dst.w - 1);
+  Color32* row = dst.row(y);
+  for (int x = x0; x <= x1; ++x) {
+    BlendPixel(Gfx::PutOptions::kBlendAlpha, row[x], col);
+  }
+}
+
+inline void VLine(PixelView dst, int x, int y0, int y1, Color32 col) {
+  if ((x < 0) || (x >= dst.w)) return;
+  y0 = std::max(y0, 0);
+  y1 = std::min(y1, dst.h - 1);
+  for (int y = y0; y <= y1; ++y) {
+    BlendPixel(Gfx::PutOptions::kBlendAlpha, dst.row(y)[x], col);
+  }
+}
+
+}  // namespace
+
+void Clear(PixelView dst, Color32 col) {
+  for (int y = 0; y < dst.h; ++y) std::fill_n(dst.row(y), dst.w, col);
+}
+
+void Point(PixelView dst, ivec2 p, Color32 col) {
+  if ((p.x < 0) || (p.y < 0) || (p.x >= dst.w) || (p.y >= dst.h)) return;
+  BlendPixel(Gfx::PutOptions::kBlendAlpha, dst.row(p.y)[p.x], col);
+}
+
+void Line(PixelView dst, ivec2 a, ivec2 b, Color32 col) {
+  if (a.y == b.y) {
+    HLine(dst, std::min(a.x, b.x), std::max(a.x, b.x), a.y, col);
+    return;
+  }
+  if (a.x == b.x) {
+    VLine(dst, a.x, std::min(a.y, b.y), std::max(a.y, b.y), col);
+    return;
+  }
+  ForEachLinePoint(a, b, [&](ivec2 p) { Point(dst, p, col); });
+}
+
+void Rect(PixelView dst, ivec2 p, ivec2 dims, Color32 col) {
+  if ((dims.x <= 0) || (dims.y <= 0)) return;
+  const ivec2 q = p + dims - ivec2{1, 1};
+  HLine(dst, p.x, q.x, p.y, col);
+  if (q.y == p.y) return;
+  HLine(dst, p.x, q.x, q.y, col);
+  VLine(dst, p.x, p.y + 1, q.y - 1, col);
+  if (q.x != p.x) VLine(dst, q.x, p.y + 1, q.y - 1, col);
+}
+
+void FillRect(PixelView dst, ivec2 p, ivec2 dims, Color32 col) {
+  if (!ClipRect(dst, p, dims)) return;
+  const bool opaque = (col.value & 0xff) == 0xff;
+  for (int y = p.y; y < p.y + dims.y; ++y) {
+    Color32* row = dst.row(y) + p.x;
+    if (opaque) {
+      std::fill_n(row, dims.x, col);
+      continue;
+    }
+    for (int x = 0; x < dims.x; ++x) {
+      BlendPixel(Gfx::PutOptions::kBlendAlpha, row[x], col);
+    }
+  }
+}
+
+void Blit(PixelView dst, ivec2 dst_p, PixelView src, ivec2 src_p, ivec2 dims,
+          Gfx::PutOptions::BlendMode blend, Color32 mod) {
+  // Clip against the source, then the destination, keeping both rects in
+  // step.
+  ivec2 clipped_p = src_p;
+  if (!ClipRect(src, clipped_p, dims)) return;
+  dst_p += clipped_p - src_p;
+  src_p = clipped_p;
+
+  clipped_p = dst_p;
+  if (!ClipRect(dst, clipped_p, dims)) return;
+  src_p += clipped_p - dst_p;
+  dst_p = clipped_p;
+
+  for (int y = 0; y < dims.y; ++y) {
+    blend::BlendSpan(blend, dst.row(dst_p.y + y) + dst_p.x,
+                     src.row(src_p.y + y) + src_p.x, dims.x, mod);
+  }
+}
+
+}  // namespace raster
+}  // namespace gfx
+}  // namespace land15
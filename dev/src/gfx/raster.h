@@ -0,0 +1,62 @@
+#ifndef LAND15_GFX_RASTER_H_
+#define LAND15_GFX_RASTER_H_
+
+#include <stdlib.h>
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+#include "glm/vec2.hpp"
+
+// CPU rasterization routines used by the software backend of Gfx. Everything is
+// clipped to the bounds of the destination and follows the semantics of the
+// equivalent SDL_Renderer call (primitives are alpha blended, Clear is not).
+
+namespace land15 {
+namespace gfx {
+namespace raster {
+
+void Clear(PixelView dst, Color32 col);
+
+void Point(PixelView dst, glm::ivec2 p, Color32 col);
+
+// Both end points are drawn.
+void Line(PixelView dst, glm::ivec2 a, glm::ivec2 b, Color32 col);
+
+// Calls `fn` with each point of the line from `a` to `b`, the points Line()
+// draws, for drawing lines some other way.
+template <typename Fn>
+void ForEachLinePoint(glm::ivec2 a, glm::ivec2 b, Fn&& fn) {
+  // Bresenham's
+  const int dx = abs(b.x - a.x);
+  const int dy = -abs(b.y - a.y);
+  const int sx = a.x < b.x ? 1 : -1;
+  const int sy = a.y < b.y ? 1 : -1;
+  int err = dx + dy;
+  while (true) {
+    fn(a);
+    if (a == b) return;
+    const int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      a.x += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      a.y += sy;
+    }
+  }
+}
+
+// Outlines/fills the `dims` sized rect whose top left corner is `p`.
+void Rect(PixelView dst, glm::ivec2 p, glm::ivec2 dims, Color32 col);
+void FillRect(PixelView dst, glm::ivec2 p, glm::ivec2 dims, Color32 col);
+
+// Draws the `dims` sized region of `src` at `src_p` to `dst_p` in `dst`.
+void Blit(PixelView dst, glm::ivec2 dst_p, PixelView src, glm::ivec2 src_p,
+          glm::ivec2 dims, Gfx::PutOptions::BlendMode blend, Color32 mod);
+
+}  // namespace raster
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_RASTER_H_
@@ -0,0 +1,131 @@
+#include "gfx/text_cache.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace gfx {
+
+using glm::ivec2;
+using std::string_view;
+
+namespace {
+
+size_t ImageBytes(ivec2 dims) { return size_t{4} * dims.x * dims.y; }
+
+}  // namespace
+
+bool TextCache::Key::operator==(const Key& other) const {
+  return (text == other.text) && (dims == other.dims) &&
+         (color == other.color) && (h_align == other.h_align) &&
+         (v_align == other.v_align);
+}
+
+size_t TextCache::KeyHash::operator()(const Key& key) const {
+  size_t h = std::hash<string_view>()(key.text);
+  for (const size_t x :
+       {static_cast<size_t>(key.dims.x), static_cast<size_t>(key.dims.y),
+        static_cast<size_t>(key.color), static_cast<size_t>(key.h_align),
+        static_cast<size_t>(key.v_align)}) {
+    h ^= x + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+TextCache::TextCache(size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+void TextCache::TextParagraph(string_view text, ivec2 a, ivec2 b,
+                              Color32 color, Gfx::TextHAlign h_align,
+                              Gfx::TextVAlign v_align) {
+  const Image* image =
+      (a.x <= b.x) && (a.y <= b.y)
+          ? Lookup(text, b - a + ivec2{1, 1}, color, h_align, v_align)
+          : nullptr;
+  if (image == nullptr) {
+    Gfx::TextParagraph(text, a, b, color, h_align, v_align);
+    return;
+  }
+  Gfx::Put(*image, a);
+}
+
+void TextCache::TextParagraph(const Image& target, string_view text, ivec2 a,
+                              ivec2 b, Color32 color, Gfx::TextHAlign h_align,
+                              Gfx::TextVAlign v_align) {
+  const Image* image =
+      (a.x <= b.x) && (a.y <= b.y)
+          ? Lookup(text, b - a + ivec2{1, 1}, color, h_align, v_align)
+          : nullptr;
+  if (image == nullptr) {
+    Gfx::TextParagraph(target, text, a, b, color, h_align, v_align);
+    return;
+  }
+  Gfx::Put(target, *image, a);
+}
+
+const Image* TextCache::Lookup(string_view text, ivec2 dims, Color32 color,
+                               Gfx::TextHAlign h_align,
+                               Gfx::TextVAlign v_align) {
+  // Text is always drawn opaque.
+  const Key key{text, dims, color | 0xff, h_align, v_align};
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    ++stats_.hits;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->image.get();
+  }
+  ++stats_.misses;
+
+  const size_t bytes = ImageBytes(dims);
+  if (bytes > budget_bytes_) return nullptr;
+  EvictTo(budget_bytes_ - bytes);
+
+  std::unique_ptr<Image> image = Image::OfSize(dims);
+  Gfx::Cls(*image, Color32::kTransparentBlack);
+  Gfx::TextParagraph(*image, text, {0, 0}, dims - ivec2{1, 1}, color, h_align,
+                     v_align);
+
+  entries_.push_front({std::string(text), key, std::move(image)});
+  Entry& entry = entries_.front();
+  entry.key.text = entry.text;
+  index_.emplace(entry.key, entries_.begin());
+  stats_.bytes += bytes;
+  ++stats_.entries;
+  return entry.image.get();
+}
+
+void TextCache::EvictTo(size_t budget_bytes) {
+  while (stats_.bytes > budget_bytes) {
+    const Entry& entry = entries_.back();
+    stats_.bytes -= ImageBytes(entry.key.dims);
+    --stats_.entries;
+    ++stats_.evictions;
+    index_.erase(entry.key);
+    entries_.pop_back();
+  }
+}
+
+void TextCache::SetBudget(size_t budget_bytes) {
+  budget_bytes_ = budget_bytes;
+  EvictTo(budget_bytes_);
+}
+
+void TextCache::Clear() {
+  index_.clear();
+  entries_.clear();
+  stats_.bytes = 0;
+  stats_.entries = 0;
+}
+
+}  // namespace gfx
+}  // namespace land15
@@ -0,0 +1,103 @@
+#ifndef LAND15_GFX_TEXT_CACHE_H_
+#define LAND15_GFX_TEXT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "gfx/core.h"
+#include "gfx/gfx.h"
+#include "gfx/image.h"
+#include "glm/vec2.hpp"
+
+namespace land15 {
+namespace gfx {
+
+// An opt-in cache of rendered paragraphs for text that doesn't change from
+// frame to frame. The first time a paragraph is drawn it's laid out and
+// rendered once into an image the size of its box, and afterwards drawn with a
+// single Put. Images are evicted least recently used first to stay within a
+// memory budget (counted as 4 bytes per pixel).
+//
+// Glyphs are rendered onto transparent black and the result alpha blended
+// onto the target, which is identical to drawing them directly since the
+// system font is either fully opaque or fully transparent. Unlike with
+// Gfx::TextParagraph, text overflowing the box is clipped to it.
+//
+// Like any Image, the cache must be destroyed before Gfx is torn down.
+class TextCache {
+ public:
+  TextCache(const TextCache&) = delete;
+  TextCache& operator=(const TextCache&) = delete;
+
+  explicit TextCache(size_t budget_bytes);
+
+  // Same as Gfx::TextParagraph.
+  void TextParagraph(std::string_view text, glm::ivec2 a, glm::ivec2 b,
+                     Color32 color = Color32::kWhite,
+                     Gfx::TextHAlign h_align = Gfx::kTextAlignHLeft,
+                     Gfx::TextVAlign v_align = Gfx::kTextAlignVTop);
+  void TextParagraph(const Image& target, std::string_view text, glm::ivec2 a,
+                     glm::ivec2 b, Color32 color = Color32::kWhite,
+                     Gfx::TextHAlign h_align = Gfx::kTextAlignHLeft,
+                     Gfx::TextVAlign v_align = Gfx::kTextAlignVTop);
+
+  // Evicts entries as needed to fit a new budget.
+  void SetBudget(size_t budget_bytes);
+
+  // Evicts every entry, without counting them as evictions.
+  void Clear();
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t bytes = 0;
+    int entries = 0;
+  };
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Key {
+    // Points into the entry's copy of the text once inserted.
+    std::string_view text;
+    glm::ivec2 dims;
+    int32_t color;
+    Gfx::TextHAlign h_align;
+    Gfx::TextVAlign v_align;
+
+    bool operator==(const Key& other) const;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  struct Entry {
+    std::string text;
+    Key key;
+    std::unique_ptr<Image> image;
+  };
+  using EntryList = std::list<Entry>;
+
+  // Returns the image holding the paragraph, rendering it on a miss. Returns
+  // nullptr if it's too big to cache.
+  const Image* Lookup(std::string_view text, glm::ivec2 dims, Color32 color,
+                      Gfx::TextHAlign h_align, Gfx::TextVAlign v_align);
+
+  void EvictTo(size_t budget_bytes);
+
+  size_t budget_bytes_;
+  Stats stats_;
+  // Most recently used first.
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+};
+
+}  // namespace gfx
+}  // namespace land15
+
+#endif  // LAND15_GFX_TEXT_CACHE_H_
@@ -6,72 +6,40 @@
 #include <chrono>
 #include <memory>
 #include <string>
-#include <thread>
 #include <vector>
 
-#include "common/random.h"
+#include "common/jobs.h"
+#include "common/sim_thread.h"
+#include "game/compositor.h"
+#include "game/loop.h"
+#include "game/snowscreen.h"
 #include "gfx/gfx.h"
 #include "gfx/image.h"
+#include "gfx/image_loader.h"
+#include "gflags/gflags.h"
 #include "glm/geometric.hpp"
 #include "glm/vec2.hpp"
 #include "glog/logging.h"
 
 using namespace land15;
 
+DEFINE_string(pacing, "vsync",
+              "How frames are paced: vsync, busy (spin until each frame is "
+              "due) or hybrid (sleep, then spin).");
+DEFINE_bool(threaded_sim, false,
+            "Step the simulation on its own thread at a fixed tick, drawing "
+            "the newest state it has handed over.");
+
 namespace {
 
 const std::string kBackgroundFilename = "res/snowscreen.png";
 const std::string kFlakesFilename = "res/flakes.png";
 
-class Snowscreen {
- public:
-  Snowscreen(const Snowscreen&) = delete;
-  Snowscreen& operator=(const Snowscreen&) = delete;
-
-  Snowscreen(int count, glm::vec2 vel, float jitter, int size)
-      : vel_(vel), jitter_(jitter), size_(size) {
-    auto res = gfx::Gfx::GetResolution();
-    float buffer_x = res.y * -vel.x;
-    bounds_x_ = buffer_x < 0 ? glm::vec2(buffer_x, res.x)
-                             : glm::vec2(0, res.x + buffer_x);
-    bounds_y_ = glm::vec2(-kSnowDim_, res.y + kSnowDim_);
-    for (int i = 0; i < count; ++i) {
-      flakes_.push_back({
-          common::rndd(bounds_x_.x, bounds_x_.y),
-          common::rndd(bounds_y_.x, bounds_y_.y),
-      });
-    }
-  }
-
-  void Step() {
-    for (auto& flake_p : flakes_) {
-      flake_p += vel_ + glm::vec2(common::rndd(-jitter_, jitter_),
-                                  common::rndd(-jitter_, jitter_));
-      if ((flake_p.x < bounds_x_.x) || (flake_p.x > bounds_x_.y) ||
-          (flake_p.y < bounds_y_.x) || (flake_p.y > bounds_y_.y)) {
-        flake_p.y = 0;
-        flake_p.x = common::rndd(bounds_x_.x, bounds_x_.y);
-      }
-    }
-  }
-
-  void Draw(const gfx::Image& flake_texture) const {
-    for (const auto& flake_p : flakes_) {
-      gfx::Gfx::Put(
-          flake_texture, flake_p - glm::vec2(kSnowDim_, kSnowDim_) * 0.5f,
-          {(size_ - 1) * kSnowDim_, 0}, {size_ * kSnowDim_ - 1, kSnowDim_ - 1});
-    }
-  }
-
- private:
-  static constexpr int kSnowDim_ = 8;
-
-  const glm::vec2 vel_;
-  const float jitter_;
-  const int size_;
-  glm::vec2 bounds_x_;
-  glm::vec2 bounds_y_;
-  std::vector<glm::vec2> flakes_;
+// The snowscreen layers as handed from the simulation thread to the renderer.
+struct SnowFrame {
+  game::Snowscreen::Frame back;
+  game::Snowscreen::Frame mid;
+  game::Snowscreen::Frame front;
 };
 
 }  // namespace
@@ -81,42 +49,113 @@ constexpr int kBaseFlakeCount = 500;
 
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
 
   gfx::Gfx::Screen({320, 200}, true, "It's Snowtime!", {640, 400});
-
-  auto bg = gfx::Image::FromFile(kBackgroundFilename);
-  auto flakes = gfx::Image::FromFile(kFlakesFilename);
-
-  Snowscreen snow_back(kBaseFlakeCount, {0.5, 1}, 0.25, 1);
-  Snowscreen snow_mid(kBaseFlakeCount * 0.25, {1, 2}, 0.5, 2);
-  Snowscreen snow_front(kBaseFlakeCount * 0.1, {2, 4}, 1, 3);
-
-
-  while (!gfx::Gfx::Close() || gfx::Gfx::GetKeyPressed(gfx::Gfx::kEscape)) {
-    gfx::Gfx::SyncInputs();
-
-    snow_back.Step();
-    snow_mid.Step();
-    snow_front.Step();
-
-
-    // Backdrop
-    gfx::Gfx::Put(*bg, {0, 0}, {0, 0}, {319, 199});
-    snow_back.Draw(*flakes);
-
-    // Trees
-    gfx::Gfx::Put(*bg, {0, 0}, {320, 0}, {639, 199});
-    snow_mid.Draw(*flakes);
-
-    // Mounds
-    gfx::Gfx::Put(*bg, {0, 0}, {640, 0}, {959, 199});
-    snow_front.Draw(*flakes);
-
-
-    gfx::Gfx::Flip();
-    std::this_thread::sleep_for(
-        std::chrono::milliseconds(static_cast<int>(1000.0 / kFps)));
+  gfx::Gfx::SetDeferred(true);
+
+  // Decode the images in parallel.
+  gfx::ImageLoader loader;
+  auto pending_bg = loader.Load(kBackgroundFilename);
+  auto pending_flakes = loader.Load(kFlakesFilename);
+  loader.Finish();
+  auto bg = pending_bg->Release();
+  auto flakes = pending_flakes->Release();
+
+  game::Snowscreen snow_back(kBaseFlakeCount, {0.5, 1}, 0.25, 1);
+  game::Snowscreen snow_mid(kBaseFlakeCount * 0.25, {1, 2}, 0.5, 2);
+  game::Snowscreen snow_front(kBaseFlakeCount * 0.1, {2, 4}, 1, 3);
+
+  common::JobSystem jobs;
+
+  // The layers are independent, so step them all at once.
+  auto step = [&] {
+    jobs.Wait({jobs.Submit([&] { snow_back.Step(jobs); }),
+               jobs.Submit([&] { snow_mid.Step(jobs); }),
+               jobs.Submit([&] { snow_front.Step(jobs); })});
+  };
+
+  // The flakes drawn by the compositor are those handed over by the simulation
+  // thread when there's one, otherwise the live ones.
+  const SnowFrame* sim_frame = nullptr;
+  auto flake_layer = [&](const game::Snowscreen& live,
+                         game::Snowscreen::Frame SnowFrame::*handed) {
+    return [&sim_frame, &flakes, live = &live, handed] {
+      if (sim_frame != nullptr) {
+        (sim_frame->*handed).Draw(*flakes);
+      } else {
+        live->Draw(*flakes);
+      }
+    };
+  };
+
+  // The backdrop is opaque, so it's copied over the whole screen. The trees
+  // and mounds only cover part of their slices of the image, rows 1 to 193
+  // and 149 to 199.
+  game::Compositor scene;
+  scene.AddStatic(*bg, {0, 0},
+                  gfx::Gfx::PutOptions().SetBlend(
+                      gfx::Gfx::PutOptions::kBlendNone),
+                  {0, 0}, {319, 199});
+  scene.AddDynamic(flake_layer(snow_back, &SnowFrame::back));
+  scene.AddStatic(*bg, {0, 1}, {320, 1}, {639, 193});
+  scene.AddDynamic(flake_layer(snow_mid, &SnowFrame::mid));
+  scene.AddStatic(*bg, {0, 149}, {640, 149}, {959, 199});
+  scene.AddDynamic(flake_layer(snow_front, &SnowFrame::front));
+
+  game::Loop::Options loop_options;
+  loop_options.tick_rate = kFps;
+  loop_options.frame_rate = kFps;
+  if (FLAGS_pacing == "busy") {
+    loop_options.pacing = game::Loop::kPacingBusyWait;
+  } else if (FLAGS_pacing == "hybrid") {
+    loop_options.pacing = game::Loop::kPacingHybrid;
+  } else {
+    CHECK_EQ(FLAGS_pacing, "vsync") << "Unknown pacing: " << FLAGS_pacing;
+  }
+  game::Loop loop(loop_options);
+  auto check_quit = [&loop] {
+    if (gfx::Gfx::Close() || gfx::Gfx::GetKeyPressed(gfx::Gfx::kEscape)) {
+      loop.Stop();
+    }
+  };
+
+  if (FLAGS_threaded_sim) {
+    common::SimulationThread<SnowFrame> sim(
+        std::chrono::nanoseconds(1000000000 / kFps), [&](SnowFrame& frame) {
+          step();
+          snow_back.Capture(frame.back);
+          snow_mid.Capture(frame.mid);
+          snow_front.Capture(frame.front);
+        });
+
+    // Ticks happen on the simulation thread, so the loop only renders.
+    loop.Run([](double) {},
+             [&](float) {
+               check_quit();
+               sim_frame = &sim.BeginFrame();
+               scene.Draw();
+               sim.EndFrame();
+             });
+
+    const auto stats = sim.stats();
+    LOG(INFO) << "Simulated " << stats.ticks << " ticks in "
+              << stats.sim_seconds << "s, " << stats.overlap() * 100
+              << "% of it while rendering. " << stats.fresh_frames
+              << " new frames, " << stats.repeated_frames << " repeated, "
+              << stats.dropped() << " ticks never drawn.";
+  } else {
+    loop.Run([&](double) { step(); },
+             [&](float) {
+               check_quit();
+               scene.Draw();
+             });
   }
 
+  const game::Loop::Stats stats = loop.stats();
+  LOG(INFO) << stats.frames << " frames, " << stats.ticks << " ticks ("
+            << stats.dropped_ticks << " dropped). Frame time "
+            << stats.frame_ms_avg << "ms [" << stats.frame_ms_min << ", "
+            << stats.frame_ms_max << "], jitter " << stats.jitter_ms << "ms.";
   return 0;
 }
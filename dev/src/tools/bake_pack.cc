@@ -0,0 +1,53 @@
+// Bakes a directory of images into a resource pack (see gfx/pack.h). Images
+// are looked up in the pack by their path including the directory itself, so
+// baking "res" makes "res/flakes.png" available under the same name
+// Image::FromFile takes.
+//
+// Usage: land15_bake <directory> <output pack>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gfx/core.h"
+#include "gfx/image.h"
+#include "gfx/pack.h"
+#include "glog/logging.h"
+
+using namespace land15;
+
+namespace {
+
+bool IsImage(const std::filesystem::path& path) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return (extension == ".png") || (extension == ".bmp") ||
+         (extension == ".tga") || (extension == ".jpg");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  CHECK_EQ(argc, 3) << "Usage: " << argv[0] << " <directory> <output pack>";
+
+  const std::filesystem::path root(argv[1]);
+  // The directory's own name, even if given with a trailing separator.
+  const std::filesystem::path prefix =
+      (root.lexically_normal() / "").parent_path().filename();
+  std::vector<std::pair<std::string, gfx::PixelBuffer>> images;
+  for (const auto& file : std::filesystem::recursive_directory_iterator(root)) {
+    if (!file.is_regular_file() || !IsImage(file.path())) continue;
+    const std::string name =
+        (prefix / file.path().lexically_relative(root)).generic_string();
+    images.emplace_back(name, gfx::Image::DecodeFile(file.path().string()));
+    LOG(INFO) << "Baked " << name << " (" << images.back().second.w << "x"
+              << images.back().second.h << ")";
+  }
+  gfx::WritePack(argv[2], images);
+  return 0;
+}